@@ -1,6 +1,9 @@
-set(PYLON_INCLUDE
-    $ENV{PYLON_ROOT}/include/ 
-    $ENV{GENICAM_ROOT_V2_3}/library/CPP/include/
+find_path(PYLON_INCLUDE pylon/PylonIncludes.h
+    PATHS $ENV{PYLON_ROOT}/include/
+)
+
+find_path(GENICAM_INCLUDE GenApi/GenApi.h
+    PATHS $ENV{GENICAM_ROOT_V2_3}/library/CPP/include/
 )
 
 set(PYLON_LIBS
@@ -17,12 +20,12 @@ set(PYLON_LIBS
 
 # handle the QUIETLY and REQUIRED arguments and set PYLON_FOUND to TRUE if
 # all listed variables are TRUE
-include(${CMAKE_CURRENT_LIST_DIR}/FindPackageHandleStandardArgs.cmake)
-FIND_PACKAGE_HANDLE_STANDARD_ARGS(PYLON REQUIRED_VARS PYLON_INCLUDE PYLON_LIBS)
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(PYLON REQUIRED_VARS PYLON_INCLUDE GENICAM_INCLUDE PYLON_LIBS)
 
 if(PYLON_FOUND)
-  set( PYLON_INCLUDE_DIRS ${PYLON_INCLUDE} )
+  set( PYLON_INCLUDE_DIRS ${PYLON_INCLUDE} ${GENICAM_INCLUDE} )
   set( PYLON_LIBRARIES ${PYLON_LIBS} )
 endif()
 
-mark_as_advanced(PYLON_INCLUDE PYLON_LIBS)
+mark_as_advanced(PYLON_INCLUDE GENICAM_INCLUDE PYLON_LIBS)
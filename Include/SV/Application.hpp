@@ -2,56 +2,75 @@
 #define SV_APPLICATION_HPP
 
 #include <SV/Utility.hpp>
+#include <SV/FrameSource.hpp>
+#include <SV/FrameHandler.hpp>
 
-#include <pylon/TlFactory.h>
-#include <pylon/InstantCameraArray.h>
-
+#include <atomic>
 #include <vector>
 #include <string>
+#include <memory>
 #include <fstream>
 
 
+class StereoPipeline;
+class StereoSynchronizer;
+class StereoCalibrator;
+class ImageWriter;
+
+
 class Application
 {
     public:
         struct CalibrationParameters
         {
-            CalibrationParameters(bool c, unsigned int n, unsigned int w, unsigned int h, float s, float d)
+            CalibrationParameters(bool c, unsigned int n, unsigned int w, unsigned int h, float s, float d, unsigned int r)
             : calibrated(c)
             , numberPhotos(n)
             , width(w)
             , height(h)
             , size(s)
             , delay(d)
+            , pair(r)
             {                
             }
             bool calibrated;
             unsigned int numberPhotos, width, height;
             float size, delay;
+            // Rig pair calibrated by calibrate()
+            unsigned int pair;
         };
 
         
     public:
-                                    Application(CalibrationParameters calibrationParameters);
+                                    Application(CalibrationParameters calibrationParameters, std::unique_ptr<FrameSource> frameSource, bool headless, std::string recordingFile);
         void                        run();
 
 
     private:
         void                        calibrate();
         void                        capture();
+        // Raw frames of every camera to mRecordingFile, no processing, until Ctrl+C or the end of the frame source
+        void                        record();
         void                        scheduleCalibration();
-        void                        attachDevices();
-        void                        registerCameraCalibration(bool* synchronizedPtr, unsigned int* grabCountPtr, std::ofstream* imageListFilePtr, std::pair<bool, bool>* wroteToFilePairPtr);
-        void                        registerCameraCapture(SV::StereoPhoto* stereoPhotoPtr);   
+        void                        openFrameSource();
+        void                        scheduleTransportDelays(double processingPeriod);
+        bool                        dispatchFrame(unsigned int timeout);
+        // cv::waitKey(), or a plain sleep without windows; returns the key pressed, -1 for none
+        int                         waitKey(int delay);
+        void                        registerCameraCalibration(const SV::RigPair& rigPair, StereoSynchronizer* stereoSynchronizerPtr, StereoCalibrator* stereoCalibratorPtr, std::atomic<unsigned int>* grabCountPtr, ImageWriter* imageWriterPtr, std::ofstream* imageListFilePtr);
+        // Appends the handlers of both cameras of the pair
+        void                        registerCameraCapture(const SV::RigPair& rigPair, StereoPipeline* stereoPipelinePtr, std::shared_ptr<const CalibrationBundle> calibrationBundle);   
         
 
     private:
-        Pylon::PylonAutoInitTerm    mAutoInitTerm;
-        Pylon::CTlFactory&          mTransportLayerFactory;
-        Pylon::DeviceInfoList_t     mDevices;
-        Pylon::CInstantCameraArray  mCameras;   
-        std::vector<std::string>    mCameraNames; 
-        CalibrationParameters       mCalibrationParameters;
+        std::unique_ptr<FrameSource>                mFrameSource;
+        std::vector<std::unique_ptr<FrameHandler>>  mFrameHandlers;
+        std::vector<std::string>                    mCameraNames; 
+        std::vector<SV::RigPair>                    mRig;
+        CalibrationParameters                       mCalibrationParameters;
+        bool                                        mHeadless;
+        std::string                                 mRecordingFile;
+        std::shared_ptr<const CalibrationBundle>    mCalibrationBundle;
 };
 
 #endif // SV_APPLICATION_HPP
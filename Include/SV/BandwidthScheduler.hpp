@@ -0,0 +1,89 @@
+#ifndef SV_BANDWIDTHSCHEDULER_HPP
+#define SV_BANDWIDTHSCHEDULER_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+namespace SV
+{
+    // Bytes on the wire around each GevSCPSPacketSize packet: Ethernet header and FCS (18), preamble (8) and
+    // inter-frame gap (12)
+    const int                               ETHERNET_FRAMING = 38;
+
+    // GigE Vision stream of one camera, as configured by its .pfs profile
+    struct StreamParameters
+    {
+        StreamParameters()
+        : imageSize()
+        , bitsPerPixel(8)
+        , packetSize(1500)
+        , tickFrequency(125000000.)
+        {
+        }
+
+        cv::Size                            imageSize;
+        int                                 bitsPerPixel;
+        // GevSCPSPacketSize: IP, UDP and GVSP headers plus payload, bytes
+        int                                 packetSize;
+        // GevTimestampTickFrequency: unit of the delays, ticks per second
+        double                              tickFrequency;
+    };
+
+    // GevSCPD and GevSCFTD of one camera, in camera ticks
+    struct TransportDelays
+    {
+        TransportDelays()
+        : interPacketDelay(0)
+        , frameTransmissionDelay(0)
+        {
+        }
+
+        int64_t                             interPacketDelay;
+        int64_t                             frameTransmissionDelay;
+    };
+}
+
+/*
+Inter-packet (GevSCPD) and frame transmission (GevSCFTD) delays for cameras sharing one NIC.
+Free-running cameras expose together, so their frames reach the switch at the same instant. Each camera leaves a gap
+after every packet wide enough for one packet of every other camera, and starts its frame that far into the cycle that
+their packets interleave instead of colliding in the switch buffer (which costs resends). When the link is not the
+bottleneck (the pipeline is slower, measured processing period), the gaps grow so each frame is spread over the
+period the pipeline needs anyway, keeping the link and the host's receive path free of bursts.
+*/
+class BandwidthScheduler
+{
+    public:
+        struct Schedule
+        {
+            std::vector<SV::TransportDelays>    delays;
+            // Frame period the delays were computed for, seconds
+            double                              framePeriod;
+            // Shortest frame period the link allows for all cameras, seconds
+            double                              linkPeriod;
+        };
+
+
+    public:
+        // linkBandwidth in bytes per second; margin is the fraction of the link kept free (0.1 = 10%)
+                                            BandwidthScheduler(double linkBandwidth, double margin);
+
+        // processingPeriod: seconds per frame of the slowest pipeline stage, 0 when unknown
+        Schedule                            compute(const std::vector<SV::StreamParameters>& streams, double processingPeriod) const;
+
+        // Ethernet, IP, UDP and GVSP framing around the payload of each packet
+        static size_t                       getPacketsPerFrame(const SV::StreamParameters& stream);
+        double                              getPacketTime(const SV::StreamParameters& stream) const;
+        double                              getLinkBandwidth() const;
+
+
+    private:
+        double                              mLinkBandwidth;
+        double                              mMargin;
+};
+
+#endif // SV_BANDWIDTHSCHEDULER_HPP
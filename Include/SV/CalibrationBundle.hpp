@@ -0,0 +1,79 @@
+#ifndef SV_CALIBRATIONBUNDLE_HPP
+#define SV_CALIBRATIONBUNDLE_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+
+/*
+Read-only set of named calibration matrices (Q, mx1, my1, mx2, my2, ...).
+The binary bundle is a versioned file that is memory-mapped instead of parsed: matrices are
+headers over the mapping, so loading is near-instant and one instance is shared by every camera.
+The XML files written by the StereoCalibration module remain supported as a fallback.
+
+Layout: Header | Entry[numberOfEntries] | 64-byte aligned matrix data
+*/
+class CalibrationBundle
+{
+    public:
+        typedef std::pair<std::string, cv::Mat>             NamedMatrix;
+
+        static const char                                   MAGIC[8];
+        static const uint32_t                               VERSION;
+        static const std::string                            FILE_NAME;
+
+        struct Header
+        {
+            char                                            magic[8];
+            uint32_t                                        version;
+            uint32_t                                        numberOfEntries;
+        };
+
+        struct Entry
+        {
+            char                                            name[16];
+            int32_t                                         rows;
+            int32_t                                         cols;
+            int32_t                                         type;
+            uint32_t                                        reserved;
+            uint64_t                                        offset;
+            uint64_t                                        size;
+        };
+
+
+    public:
+                                                            ~CalibrationBundle();
+                                                            CalibrationBundle(const CalibrationBundle&) = delete;
+        CalibrationBundle&                                  operator=(const CalibrationBundle&) = delete;
+
+        // Both return an empty pointer (and log why) when the calibration can not be loaded
+        static std::shared_ptr<const CalibrationBundle>     loadBinaryFile(const std::string& bundleFile);
+        static std::shared_ptr<const CalibrationBundle>     loadXMLFiles(const std::string& xmlFilesPath, const std::vector<std::string>& names);
+        static std::shared_ptr<const CalibrationBundle>     createFromMatrices(const std::vector<NamedMatrix>& matrices);
+        static void                                         saveBinaryFile(const std::string& bundleFile, const std::vector<NamedMatrix>& matrices);
+
+        // Empty matrix when name is not in the bundle; data must not be written
+        cv::Mat                                             getMatrix(const std::string& name) const;
+        const std::vector<NamedMatrix>&                     getMatrices() const;
+        bool                                                isMemoryMapped() const;
+        // Identifies the calibration (hash of every matrix); costs a pass over the maps, so call it once
+        uint64_t                                            getChecksum() const;
+
+
+    private:
+                                                            CalibrationBundle();
+
+
+    private:
+        std::vector<NamedMatrix>                            mMatrices;
+        void*                                               mMapping;
+        size_t                                              mMappingSize;
+};
+
+#endif // SV_CALIBRATIONBUNDLE_HPP
@@ -2,37 +2,47 @@
 #define SV_CAMERACALIBRATION_HPP
 
 
-#include <pylon/ImageEventHandler.h>
+#include <SV/FrameHandler.hpp>
+#include <SV/FrameBufferPool.hpp>
 
 #include <opencv2/core/core.hpp>
 
+#include <atomic>
+#include <vector>
 #include <string>
 #include <fstream>
-#include <utility>
 
 
-namespace Pylon
-{
-    class CInstantCamera;
-    class CGrabResultPtr;
-}
+class StereoSynchronizer;
+class StereoCalibrator;
+class ImageWriter;
 
-class CameraCalibration : public Pylon::CImageEventHandler
+class CameraCalibration : public FrameHandler
 {
 	public:
-								CameraCalibration(std::string cameraName, bool* synchronizedPtr, unsigned int* grabCountPtr, std::ofstream* imageListFilePtr, std::pair<bool, bool>* wroteToFilePairPtr);
+								CameraCalibration(std::string cameraName, cv::Size imageSize, StereoSynchronizer* stereoSynchronizerPtr, StereoCalibrator* stereoCalibratorPtr, std::atomic<unsigned int>* grabCountPtr, ImageWriter* imageWriterPtr, std::ofstream* imageListFilePtr, bool headless);
+
+		virtual void			onFrameGrabbed(const SV::Frame& frame);
 
-		virtual void			OnImageGrabbed(Pylon::CInstantCamera& camera, const Pylon::CGrabResultPtr& grabResultPtr);
+
+	private:
+		void					allocateBuffers(cv::Size imageSize);
+		static std::string		getImagePath(const std::string& imagesPath, unsigned int grabCount, size_t camera);
 
 
 	private:
 		std::string				mCameraName;
-		bool*					mSynchronizedPtr;
-		unsigned int* 			mGrabCountPtr;		
+		bool					mHeadless;
+		StereoSynchronizer*		mStereoSynchronizerPtr;
+		StereoCalibrator*		mStereoCalibratorPtr;
+		std::atomic<unsigned int>*	mGrabCountPtr;
+		ImageWriter*			mImageWriterPtr;
 		std::ofstream*			mImageListFilePtr;
-		std::pair<bool, bool>*	mWroteToFilePairPtr;
 		cv::Size       			mPatternSize;
 		float		 			mThreshold;
+		cv::Size				mImageSize;
+		FrameBufferPool			mFrameBufferPool;
+		std::vector<cv::Point2f>	mCorners;
 };
 
 #endif // SV_CAMERACALIBRATION_HPP
@@ -3,47 +3,49 @@
 
 
 #include <SV/Utility.hpp>
-
-#include <pylon/ImageEventHandler.h>
+#include <SV/FrameHandler.hpp>
+#include <SV/FrameBufferPool.hpp>
+#include <SV/CalibrationBundle.hpp>
+#include <SV/Rectifier.hpp>
+#include <SV/Preprocessor.hpp>
+#include <SV/SlotRing.hpp>
 
 #include <opencv2/core/core.hpp>
 
-#include <array>
+#include <memory>
 #include <string>
 
 
-// Forward Declaration
-namespace Pylon
-{
-    class CInstantCamera;
-    class CGrabResultPtr;
-}
+class StereoPipeline;
 
-namespace
-{
-	const int Q 	= 0;
-	const int MX1 	= 1;
-	const int MY1 	= 2;
-	const int MX2	= 3;
-	const int MY2 	= 4;	
-}
-
-class CameraCapture : public Pylon::CImageEventHandler
+// Preprocessing stage of one camera: gray conversion, binarization and rectification
+class CameraCapture : public FrameHandler
 {
     public:
-    										CameraCapture(std::string cameraName, SV::StereoPhoto* stereoPhotoPtr);
+    										CameraCapture(std::string cameraName, size_t camera, cv::Size imageSize, std::shared_ptr<const CalibrationBundle> calibrationBundle, StereoPipeline* stereoPipelinePtr);
 
-        virtual void    					OnImageGrabbed(Pylon::CInstantCamera& camera, const Pylon::CGrabResultPtr& grabResultPtr);
+        // Runs on the camera's pipeline thread; the rectified image is handed to the pipeline
+        virtual void    					onFrameGrabbed(const SV::Frame& frame);
+
+
+    private:
+        void                                allocateBuffers(cv::Size imageSize);
 
 
     private:
         std::string							mCameraName;
-        std::array<cv::Mat, 5>				mCalibrationMatrices;
-        const std::array<std::string, 5>	mCalibrationMatricesFiles;
-        const std::array<std::string, 5>	mCalibrationMatricesNames;
-        cv::Size                            mPatternSize;
-        SV::StereoPhoto*                    mStereoPhotoPtr;
+        size_t                              mCamera;
+        std::shared_ptr<const CalibrationBundle>    mCalibrationBundle;
+        Rectifier                           mRectifier;
+        Preprocessor                        mPreprocessor;
+        StereoPipeline*                     mStereoPipelinePtr;
         float                               mThreshold;
+        // Stands in for every frame in emulation mode; loaded once, so the pipeline is measured rather than the disk
+        cv::Mat                             mEmulatedImage;
+        cv::Size                            mImageSize;
+        FrameBufferPool                     mFrameBufferPool;
+        // Rectified buffers still owned by later stages come back through the ring from any thread
+        SlotRing                            mSlotRing;
 };
 
 #endif // SV_CAMERACAPTURE_HPP
@@ -2,6 +2,8 @@
 #define SV_CAMERACONFIGURATION_HPP
 
 
+#include <SV/BandwidthScheduler.hpp>
+
 #include <pylon/ConfigurationEventHandler.h>
 
 #include <string>
@@ -16,15 +18,16 @@ namespace Pylon
 class CameraConfiguration : public Pylon::CConfigurationEventHandler
 {
     public:
-                            CameraConfiguration(const char* configurationFile, const int interPacketDelay, int frameTransmissionDelay, std::string cameraName);
+                            CameraConfiguration(const char* configurationFile, std::string cameraName);
         void                OnOpened(Pylon::CInstantCamera& camera);
         void                OnGrabStarted(Pylon::CInstantCamera& camera);
+
+        // GevSCPD and GevSCFTD clamped to what the camera accepts; both are writable while grabbing
+        static void         setTransportDelays(Pylon::CInstantCamera& camera, const SV::TransportDelays& transportDelays, const std::string& cameraName);
         
 
     private:
         const char*         mConfigurationFile;
-        const int           mInterPacketDelay;
-        const int           mFrameTransmissionDelay;
         const std::string   mCameraName;        
 };
 
@@ -0,0 +1,65 @@
+#ifndef SV_CORNERTRACKER_HPP
+#define SV_CORNERTRACKER_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+/*
+Chessboard corners of one camera, followed from frame to frame.
+Once the board is found, its corners are carried into the next frame with pyramidal Lucas-Kanade
+flow and snapped back onto the saddle points with cornerSubPix. A track is trusted only if every corner
+survives a forward-backward check and the corners still fit the pattern grid through a homography;
+otherwise the chessboard detector runs on the whole image again (coarse to fine, see SV::findChessboardCornersCoarseToFine).
+Frames must arrive in capture order; use one tracker per camera from a single thread.
+*/
+class CornerTracker
+{
+    public:
+        struct Statistics
+        {
+            uint64_t                        tracked;
+            uint64_t                        detected;
+            uint64_t                        lost;
+        };
+
+
+    public:
+                                            CornerTracker(cv::Size patternSize, int windowSize, int pyramidLevels, float maximumError, int detectionLevels);
+
+        // True when the whole pattern was found; corners are in cv::findChessboardCorners order
+        bool                                findCorners(const cv::Mat& image, std::vector<cv::Point2f>& corners);
+        // Forgets the board, so the next frame runs the full detector
+        void                                reset();
+        Statistics                          getStatistics() const;
+
+
+    private:
+        bool                                track(const cv::Mat& image, std::vector<cv::Point2f>& corners);
+        bool                                detect(const cv::Mat& image, std::vector<cv::Point2f>& corners);
+        void                                refine(const cv::Mat& image, std::vector<cv::Point2f>& corners) const;
+        bool                                fitsPattern(const std::vector<cv::Point2f>& corners);
+
+
+    private:
+        cv::Size                            mPatternSize;
+        cv::Size                            mWindowSize;
+        int                                 mPyramidLevels;
+        float                               mMaximumError;
+        int                                 mDetectionLevels;
+        bool                                mTracking;
+        std::vector<cv::Mat>                mPyramid;
+        std::vector<cv::Mat>                mPreviousPyramid;
+        std::vector<cv::Point2f>            mPreviousCorners;
+        std::vector<cv::Point2f>            mPatternCorners;
+        std::vector<cv::Point2f>            mBackTrackedCorners;
+        std::vector<cv::Point2f>            mProjectedCorners;
+        std::vector<unsigned char>          mStatus;
+        std::vector<float>                  mError;
+        Statistics                          mStatistics;
+};
+
+#endif // SV_CORNERTRACKER_HPP
@@ -0,0 +1,45 @@
+#ifndef SV_DIRECTORYFRAMESOURCE_HPP
+#define SV_DIRECTORYFRAMESOURCE_HPP
+
+
+#include <SV/FrameSource.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <string>
+#include <utility>
+
+
+/*
+Replays the stereo photos of a directory ("00left.ppm", "00right.ppm", "01left.ppm", ...).
+Every image is loaded on open(), so grabbing measures the pipeline and not the disk.
+*/
+class DirectoryFrameSource : public FrameSource
+{
+    public:
+                                                        DirectoryFrameSource(std::string imagesPath, bool loop);
+
+        virtual void                                    open();
+        virtual void                                    close();
+        virtual bool                                    isOpen() const;
+
+        virtual void                                    startGrabbing();
+        virtual void                                    stopGrabbing();
+        virtual bool                                    isGrabbing() const;
+        virtual bool                                    retrieveFrame(SV::Frame& frame, unsigned int timeout);
+
+        virtual size_t                                  getNumberOfCameras() const;
+        virtual cv::Size                                getImageSize(size_t camera) const;
+
+
+    private:
+        std::string                                     mImagesPath;
+        bool                                            mLoop;
+        bool                                            mOpen;
+        bool                                            mGrabbing;
+        std::vector<std::pair<cv::Mat, cv::Mat>>        mStereoPhotos;
+        size_t                                          mNextFrame;
+};
+
+#endif // SV_DIRECTORYFRAMESOURCE_HPP
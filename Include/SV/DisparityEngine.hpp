@@ -0,0 +1,71 @@
+#ifndef SV_DISPARITYENGINE_HPP
+#define SV_DISPARITYENGINE_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <cstdint>
+
+
+/*
+Dense block matching on rectified stereo pairs (SAD cost, AVX2/SSE2 over image columns).
+Costs are aggregated with running sums down the columns of each row band, so a row costs
+two absolute differences per pixel and disparity regardless of the window height.
+A disparity survives when its window is textured and it agrees with the best match claiming the
+same right pixel (left-right consistency).
+Bands are processed in parallel with cv::parallel_for_; each band owns its cost buffers.
+*/
+class DisparityEngine
+{
+    public:
+        // Output is CV_16SC1 in 1/16 pixel, like cv::StereoBM
+        static const int                    DISPARITY_SCALE = 16;
+        static const short                  INVALID_DISPARITY = -DISPARITY_SCALE;
+
+
+    public:
+        // A negative leftRightTolerance disables the consistency check; 0 bands uses one per hardware thread
+                                            DisparityEngine(int numberOfDisparities, int windowSize, int textureThreshold, int leftRightTolerance, int bands);
+
+        void                                compute(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity);
+        int                                 getNumberOfDisparities() const;
+
+
+    private:
+        // Cost buffers of one band, reused from frame to frame
+        struct BandBuffers
+        {
+            // Column and window sums are laid out disparity-major: sums[x * numberOfDisparities + d]
+            std::vector<int16_t>            columnSums;
+            std::vector<int16_t>            windowSums;
+            std::vector<int32_t>            textureColumnSums;
+            std::vector<int16_t>            bestLeft;
+            std::vector<int16_t>            bestLeftDisparity;
+            // Costs at the best disparity - 1 and + 1
+            std::vector<int16_t>            previousCost;
+            std::vector<int16_t>            nextCost;
+            // Cheapest left match claiming each right pixel
+            std::vector<int16_t>            bestRight;
+            std::vector<int16_t>            bestRightDisparity;
+            std::vector<uint8_t>            reversedRows;
+        };
+
+        class BandBody;
+
+        void                                allocate(cv::Size imageSize);
+        void                                computeBand(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity, int firstRow, int lastRow, BandBuffers& buffers);
+
+
+    private:
+        int                                 mNumberOfDisparities;
+        int                                 mWindowSize;
+        int                                 mTextureThreshold;
+        int                                 mLeftRightTolerance;
+        int                                 mBands;
+        cv::Size                            mImageSize;
+        size_t                              mRowStride;
+        std::vector<BandBuffers>            mBandBuffers;
+};
+
+#endif // SV_DISPARITYENGINE_HPP
@@ -0,0 +1,46 @@
+#ifndef SV_FRAME_HPP
+#define SV_FRAME_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <memory>
+#include <cstdint>
+
+
+namespace SV
+{
+    enum PixelFormat
+    {
+        PIXEL_FORMAT_MONO8,
+        PIXEL_FORMAT_BAYERGB8,
+        PIXEL_FORMAT_BGR8
+    };
+
+    /*
+    A single image delivered by a FrameSource.
+    The image may point straight into a driver buffer; owner keeps that buffer alive
+    for as long as any copy of the Frame exists.
+    */
+    struct Frame
+    {
+        Frame()
+        : image()
+        , camera(0u)
+        , id(0u)
+        , timestamp(0u)
+        , pixelFormat(PIXEL_FORMAT_MONO8)
+        , owner()
+        {
+        }
+
+        cv::Mat                 image;
+        size_t                  camera;
+        uint64_t                id;
+        uint64_t                timestamp;
+        PixelFormat             pixelFormat;
+        std::shared_ptr<void>   owner;
+    };
+}
+
+#endif // SV_FRAME_HPP
@@ -0,0 +1,45 @@
+#ifndef SV_FRAMEBUFFERPOOL_HPP
+#define SV_FRAMEBUFFERPOOL_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <utility>
+
+
+/*
+Per-camera set of reusable image buffers carved out of one aligned block.
+Buffers are allocated (and prefaulted) once, when the camera AOI is known, so the
+steady-state frame loop never touches the heap. Rows are 64-byte aligned.
+*/
+class FrameBufferPool
+{
+    public:
+        typedef std::pair<cv::Size, int>   BufferLayout;
+
+
+    public:
+                                            FrameBufferPool(bool useHugePages);
+                                            ~FrameBufferPool();
+                                            FrameBufferPool(const FrameBufferPool&) = delete;
+        FrameBufferPool&                    operator=(const FrameBufferPool&) = delete;
+
+        void                                allocate(const std::vector<BufferLayout>& layouts);
+        void                                release();
+        bool                                isAllocated() const;
+        bool                                isHugePageBacked() const;
+
+        // Header over a pooled buffer; writing through it never reallocates as long as size and type match
+        cv::Mat                             getBuffer(size_t index) const;
+
+
+    private:
+        bool                                mUseHugePages;
+        bool                                mHugePageBacked;
+        unsigned char*                      mMemory;
+        size_t                              mMemorySize;
+        std::vector<cv::Mat>                mBuffers;
+};
+
+#endif // SV_FRAMEBUFFERPOOL_HPP
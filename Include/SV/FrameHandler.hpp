@@ -0,0 +1,17 @@
+#ifndef SV_FRAMEHANDLER_HPP
+#define SV_FRAMEHANDLER_HPP
+
+
+#include <SV/Frame.hpp>
+
+
+// Consumer of the frames of one camera; called from the Application's main loop or a pipeline thread
+class FrameHandler
+{
+    public:
+        virtual         ~FrameHandler() {}
+
+        virtual void    onFrameGrabbed(const SV::Frame& frame) = 0;
+};
+
+#endif // SV_FRAMEHANDLER_HPP
@@ -0,0 +1,78 @@
+#ifndef SV_FRAMERECORDER_HPP
+#define SV_FRAMERECORDER_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/FrameRecording.hpp>
+#include <SV/SPSCQueue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*
+Records raw frames, as delivered by the frame source, into a FrameRecording container for RecordingFrameSource.
+record() copies each frame into the open chunk in memory; full chunks are written by a writer thread with one large
+write each, so the grabbing thread never waits on the disk while a chunk is free. When every chunk is waiting for the
+disk, record() waits too: the recording never skips a frame behind the caller's back.
+record() and close() must be called from one thread.
+*/
+class FrameRecorder
+{
+    public:
+                                            FrameRecorder(const std::string& recordingFile, size_t numberOfCameras, size_t chunkSize, size_t chunks);
+                                            ~FrameRecorder();
+                                            FrameRecorder(const FrameRecorder&) = delete;
+        FrameRecorder&                      operator=(const FrameRecorder&) = delete;
+
+        void                                record(const SV::Frame& frame);
+        // Writes the open chunk and the index; throws when any write failed
+        void                                close();
+
+        uint64_t                            getRecordedFrames() const;
+        uint64_t                            getRecordedBytes() const;
+        // Time record() spent waiting for a free chunk, in seconds
+        double                              getWaitTime() const;
+
+
+    private:
+        struct Chunk
+        {
+            // Header page, then the frames
+            std::vector<unsigned char>      buffer;
+            size_t                          size;
+            uint64_t                        offset;
+            std::vector<SV::RecordedFrame>  frames;
+        };
+
+
+    private:
+        void                                submitChunk(bool reopen);
+        bool                                write(const void* data, size_t size, uint64_t offset);
+        void                                run();
+
+
+    private:
+        std::string                         mRecordingFile;
+        size_t                              mNumberOfCameras;
+        int                                 mFile;
+        std::vector<std::unique_ptr<Chunk>> mChunks;
+        // Filled chunks to the writer thread, written ones back
+        SPSCQueue<Chunk*>                   mFullChunks;
+        SPSCQueue<Chunk*>                   mFreeChunks;
+        // Open chunk, owned by the recording thread
+        Chunk*                              mChunk;
+        uint64_t                            mFileSize;
+        std::vector<SV::RecordedFrame>      mIndex;
+        uint64_t                            mRecordedBytes;
+        double                              mWaitTime;
+        std::atomic<size_t>                 mPendingChunks;
+        std::atomic<bool>                   mFailed;
+        std::atomic<bool>                   mRunning;
+        std::thread                         mThread;
+};
+
+#endif // SV_FRAMERECORDER_HPP
@@ -0,0 +1,64 @@
+#ifndef SV_FRAMERECORDING_HPP
+#define SV_FRAMERECORDING_HPP
+
+
+#include <cstdint>
+
+
+/*
+Container of raw camera frames written by FrameRecorder and replayed by RecordingFrameSource:
+    header page | chunk | chunk | ... | index
+Each chunk starts with a header page listing its frames, followed by their pixel data. Chunk headers and frame data
+start on page boundaries, so replayed frames are mapped straight from the file. The index (every frame record, in
+recording order) is written on close; a recording cut short has none, and replay rebuilds it from the chunk headers.
+*/
+namespace SV
+{
+    const char          RECORDING_MAGIC[8] = {'S', 'V', 'R', 'E', 'C', '\0', '\0', '\0'};
+    const char          RECORDING_CHUNK_MAGIC[8] = {'S', 'V', 'C', 'H', 'U', 'N', 'K', '\0'};
+    const uint32_t      RECORDING_VERSION = 1u;
+    const uint64_t      RECORDING_ALIGNMENT = 4096u;
+
+    struct RecordingHeader
+    {
+        char                    magic[8];
+        uint32_t                version;
+        uint32_t                cameras;
+        // Offset of the index; 0 while recording
+        uint64_t                indexOffset;
+        uint64_t                frames;
+    };
+
+    struct RecordedFrame
+    {
+        // Offset of the pixel data
+        uint64_t                offset;
+        uint64_t                id;
+        // As delivered by the frame source (camera ticks for Pylon)
+        uint64_t                timestamp;
+        // steady_clock nanoseconds when recorded; paces real-time replay
+        uint64_t                hostTime;
+        uint32_t                camera;
+        uint32_t                pixelFormat;
+        int32_t                 rows;
+        int32_t                 cols;
+        int32_t                 type;
+        uint32_t                step;
+        uint64_t                reserved;
+    };
+
+    struct RecordingChunkHeader
+    {
+        char                    magic[8];
+        // Header page and frame data
+        uint64_t                size;
+        uint32_t                frames;
+        uint32_t                reserved;
+        // Followed by the RecordedFrame of each frame
+    };
+
+    // Frames of a chunk are limited by what its header page can list
+    const uint32_t      RECORDING_CHUNK_FRAMES = (uint32_t) ((RECORDING_ALIGNMENT - sizeof(RecordingChunkHeader)) / sizeof(RecordedFrame));
+}
+
+#endif // SV_FRAMERECORDING_HPP
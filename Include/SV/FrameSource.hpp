@@ -0,0 +1,49 @@
+#ifndef SV_FRAMESOURCE_HPP
+#define SV_FRAMESOURCE_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/BandwidthScheduler.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <memory>
+#include <string>
+
+
+class CalibrationBundle;
+
+/*
+Abstract producer of camera frames.
+Implementations deliver the frames of every camera through retrieveFrame(), in round-robin
+order (left, right, left, ...), so the processing code never depends on a particular SDK.
+*/
+class FrameSource
+{
+    public:
+        virtual                     ~FrameSource() {}
+
+        virtual void                open() = 0;
+        virtual void                close() = 0;
+        virtual bool                isOpen() const = 0;
+
+        virtual void                startGrabbing() = 0;
+        virtual void                stopGrabbing() = 0;
+        virtual bool                isGrabbing() const = 0;
+        // Returns false when no frame arrived within timeout (ms) or the source is exhausted
+        virtual bool                retrieveFrame(SV::Frame& frame, unsigned int timeout) = 0;
+
+        virtual size_t              getNumberOfCameras() const = 0;
+        virtual std::string         getCameraName(size_t camera) const;
+        // Image size (AOI) of a camera once opened; empty when only known after the first frame
+        virtual cv::Size            getImageSize(size_t camera) const;
+        virtual bool                isEmulated() const;
+        // GigE transport of a camera once opened; false for sources without a network link
+        virtual bool                getStreamParameters(size_t camera, SV::StreamParameters& streamParameters) const;
+        // Re-tunes GevSCPD and GevSCFTD, also while grabbing; ignored by sources without a network link
+        virtual void                setTransportDelays(size_t camera, const SV::TransportDelays& transportDelays);
+        // Exact calibration of a pair, for virtual rigs; null when the pair must be calibrated
+        virtual std::shared_ptr<const CalibrationBundle>    getCalibrationBundle(size_t left, size_t right) const;
+};
+
+#endif // SV_FRAMESOURCE_HPP
@@ -0,0 +1,48 @@
+#ifndef SV_GIGELINKSIMULATOR_HPP
+#define SV_GIGELINKSIMULATOR_HPP
+
+
+#include <SV/BandwidthScheduler.hpp>
+
+#include <vector>
+
+
+/*
+Packet-level model of free-running GigE cameras behind one switch port, to try transport delays without hardware.
+Every camera exposes at the start of each frame period, waits its frame transmission delay, then sends full-size
+packets separated by its inter-packet delay. The switch queues packets for the shared link and drops any that do not
+fit its buffer; on a real link each drop is a resend request, so a frame with drops counts as incomplete.
+A camera holds at most cameraBufferFrames frames waiting to be sent and skips exposures beyond that.
+*/
+class GigELinkSimulator
+{
+    public:
+        struct Statistics
+        {
+            // Per camera
+            std::vector<double>                 frameRates;
+            std::vector<size_t>                 packets;
+            std::vector<size_t>                 droppedPackets;
+            std::vector<size_t>                 incompleteFrames;
+            std::vector<size_t>                 skippedFrames;
+            // Bytes queued in the switch at worst
+            size_t                              maximumBacklog;
+            // Seconds from exposure to the last packet on the link, complete frames only
+            double                              meanLatency;
+        };
+
+
+    public:
+                                            GigELinkSimulator(double linkBandwidth, size_t switchBufferBytes, size_t cameraBufferFrames);
+
+        // duration in seconds of simulated capture at framePeriod seconds per frame
+        Statistics                          run(const std::vector<SV::StreamParameters>& streams, const std::vector<SV::TransportDelays>& delays, double framePeriod, double duration) const;
+
+
+    private:
+        double                              mLinkBandwidth;
+        size_t                              mSwitchBufferBytes;
+        size_t                              mCameraBufferFrames;
+};
+
+#endif // SV_GIGELINKSIMULATOR_HPP
@@ -0,0 +1,41 @@
+#ifndef SV_IMAGEPROCESSING_HPP
+#define SV_IMAGEPROCESSING_HPP
+
+
+#include <SV/Frame.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <array>
+#include <vector>
+
+
+namespace SV
+{
+    /* Types */
+    typedef std::array<size_t, 256>     Histogram;
+
+
+    /* Functions */
+    // For Mono8 input imageGray becomes a header over image instead of a copy; binning only applies to Bayer input
+    void                        convertToGray(const cv::Mat& image, PixelFormat pixelFormat, cv::Mat& imageGray, bool binning);
+    // Gray rows [firstRow, lastRow) of convertToGray(), into an imageGray already allocated; bands of one image can run
+    // in parallel. Does nothing for Mono8, where imageGray is image itself
+    void                        convertToGrayRows(const cv::Mat& image, PixelFormat pixelFormat, cv::Mat& imageGray, bool binning, int firstRow, int lastRow);
+    cv::Size                    getGraySize(cv::Size imageSize, PixelFormat pixelFormat, bool binning);
+
+    // Single pass BayerGB8 to luma, without the 3-channel intermediate; binning halves both dimensions
+    void                        bayerGBToGray(const cv::Mat& bayer, cv::Mat& imageGray, bool binning);
+    void                        bayerGBToGrayRows(const cv::Mat& bayer, cv::Mat& imageGray, bool binning, int firstRow, int lastRow);
+
+    // Pixel counts of rows [firstRow, lastRow) of an 8-bit image; histograms of bands add up to the image's
+    void                        countHistogramRows(const cv::Mat& image, Histogram& histogram, int firstRow, int lastRow);
+    // Threshold cv::threshold(THRESH_OTSU) picks for an 8-bit image with this histogram
+    double                      getOtsuThreshold(const Histogram& histogram);
+
+    // cv::findChessboardCorners on the image shrunk by 2^levels, then cornerSubPix around each hit at full resolution;
+    // corners come back in the same order. levels 0 is the plain full resolution search
+    bool                        findChessboardCornersCoarseToFine(const cv::Mat& image, cv::Size patternSize, std::vector<cv::Point2f>& corners, int levels);
+}
+
+#endif // SV_IMAGEPROCESSING_HPP
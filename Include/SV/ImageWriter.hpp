@@ -0,0 +1,54 @@
+#ifndef SV_IMAGEWRITER_HPP
+#define SV_IMAGEWRITER_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/SPSCQueue.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*
+Writes images to disk on its own thread, so file system latency never stalls the thread grabbing frames.
+Queued frames keep their buffers alive through Frame::owner until written. The queue is bounded:
+write() waits for room when the disk falls behind. Images go through cv::imwrite, so the format follows
+the file extension; PNG is lossless and written with a fast compression level.
+write() and flush() must be called from one thread.
+*/
+class ImageWriter
+{
+    public:
+                                            ImageWriter(size_t capacity, int pngCompression);
+                                            ~ImageWriter();
+                                            ImageWriter(const ImageWriter&) = delete;
+        ImageWriter&                        operator=(const ImageWriter&) = delete;
+
+        void                                write(const std::string& imagePath, SV::Frame frame);
+        // Blocks until every image queued so far is on disk
+        void                                flush();
+        size_t                              getFailedWrites() const;
+
+
+    private:
+        struct Job
+        {
+            std::string                     imagePath;
+            SV::Frame                       frame;
+        };
+
+        void                                run();
+
+
+    private:
+        SPSCQueue<Job>                      mQueue;
+        std::vector<int>                    mPngParameters;
+        std::atomic<size_t>                 mPendingWrites;
+        std::atomic<size_t>                 mFailedWrites;
+        std::atomic<bool>                   mRunning;
+        std::thread                         mThread;
+};
+
+#endif // SV_IMAGEWRITER_HPP
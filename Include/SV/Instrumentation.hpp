@@ -0,0 +1,148 @@
+#ifndef SV_INSTRUMENTATION_HPP
+#define SV_INSTRUMENTATION_HPP
+
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+
+namespace SV
+{
+    // Timed work of the capture pipeline, in the order a frame meets it
+    enum Stage
+    {
+        STAGE_GRAB_WAIT,
+        STAGE_GRAY,
+        STAGE_THRESHOLD,
+        STAGE_REMAP,
+        STAGE_MATCH,
+        STAGE_DETECTION,
+        STAGE_TRIANGULATION,
+        STAGE_DRAWING,
+        STAGE_DISPLAY,
+        NUMBER_OF_STAGES
+    };
+
+    enum Counter
+    {
+        COUNTER_GRABBED,
+        COUNTER_RECTIFIED,
+        COUNTER_PAIRED,
+        COUNTER_PRESENTED,
+        // No free rectified slot: the pipeline was saturated
+        COUNTER_DROPPED_SATURATED,
+        // Preprocessing queue full while other pairs share the grab thread
+        COUNTER_DROPPED_BUSY,
+        // Image size changed while old buffers were still in flight
+        COUNTER_DROPPED_RESIZE,
+        // Paired without a disparity map, every disparity slot was in flight
+        COUNTER_DROPPED_DISPARITY,
+        // Finished after a newer pair was already handed to the display
+        COUNTER_DROPPED_PRESENT,
+        // Replaced in the display mailbox before the display took it
+        COUNTER_DROPPED_DISPLAY,
+        NUMBER_OF_COUNTERS
+    };
+}
+
+/*
+Lock-free latency histogram with log-linear buckets: exact below 16 ns, then 8 buckets per power of two
+(12.5% resolution) up to 2^64 ns. Any thread may record; readers see a consistent enough snapshot for statistics.
+*/
+class LatencyHistogram
+{
+    public:
+        struct Summary
+        {
+            uint64_t                            count;
+            // Nanoseconds; percentiles are bucket upper bounds
+            double                              mean;
+            uint64_t                            p50;
+            uint64_t                            p99;
+            uint64_t                            maximum;
+        };
+
+
+    public:
+                                                LatencyHistogram();
+
+        void                                    record(uint64_t nanoseconds);
+        // Summary of what was recorded since the last call; starts a new interval
+        Summary                                 collect();
+
+
+    private:
+        static const size_t                     SUB_BUCKETS = 8;
+        static const size_t                     NUMBER_OF_BUCKETS = 16 + (64 - 4) * SUB_BUCKETS;
+
+        static size_t                           getBucket(uint64_t nanoseconds);
+        static uint64_t                         getUpperBound(size_t bucket);
+
+
+    private:
+        std::atomic<uint64_t>                   mBuckets[NUMBER_OF_BUCKETS];
+        std::atomic<uint64_t>                   mCount;
+        std::atomic<uint64_t>                   mSum;
+        std::atomic<uint64_t>                   mMaximum;
+};
+
+/*
+Stage latencies and frame counters of the capture pipeline.
+Stages record through ScopedTimer; dump() prints the interval since the previous dump and starts a new one.
+*/
+class Instrumentation
+{
+    public:
+        class ScopedTimer
+        {
+            public:
+                                                ScopedTimer(Instrumentation* instrumentation, SV::Stage stage)
+                                                : mInstrumentation(instrumentation)
+                                                , mStage(stage)
+                                                , mStart(std::chrono::steady_clock::now())
+                                                {
+                                                }
+
+                                                ~ScopedTimer()
+                                                {
+                                                    if (mInstrumentation)
+                                                        mInstrumentation->record(mStage, std::chrono::steady_clock::now() - mStart);
+                                                }
+
+                                                ScopedTimer(const ScopedTimer&) = delete;
+                ScopedTimer&                    operator=(const ScopedTimer&) = delete;
+
+
+            private:
+                Instrumentation*                mInstrumentation;
+                SV::Stage                       mStage;
+                std::chrono::steady_clock::time_point   mStart;
+        };
+
+
+    public:
+                                                Instrumentation();
+
+        void                                    record(SV::Stage stage, std::chrono::steady_clock::duration duration);
+        void                                    count(SV::Counter counter, uint64_t increment = 1u);
+        // Call from one thread
+        void                                    dump(std::ostream& stream);
+        // Latencies of the interval closed by the last dump(); same thread as dump()
+        LatencyHistogram::Summary               getSummary(SV::Stage stage) const;
+
+        static const char*                      getStageName(SV::Stage stage);
+        static const char*                      getCounterName(SV::Counter counter);
+
+
+    private:
+        LatencyHistogram                        mHistograms[SV::NUMBER_OF_STAGES];
+        std::atomic<uint64_t>                   mCounters[SV::NUMBER_OF_COUNTERS];
+        // Counter values at the previous dump
+        uint64_t                                mDumpedCounters[SV::NUMBER_OF_COUNTERS];
+        LatencyHistogram::Summary               mSummaries[SV::NUMBER_OF_STAGES];
+        std::chrono::steady_clock::time_point   mIntervalStart;
+};
+
+#endif // SV_INSTRUMENTATION_HPP
@@ -0,0 +1,120 @@
+#ifndef SV_MPMCQUEUE_HPP
+#define SV_MPMCQUEUE_HPP
+
+
+#include <SV/SPSCQueue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <utility>
+
+
+/*
+Bounded lock-free queue for any number of producers and consumers (D. Vyukov's design).
+Every cell carries a sequence number telling whether it is ready to be written or read
+for the current lap, so producers and consumers only contend on their own index.
+*/
+template <typename T>
+class MPMCQueue
+{
+    public:
+        explicit                            MPMCQueue(size_t capacity);
+                                            MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue&                          operator=(const MPMCQueue&) = delete;
+
+        // Returns false when the queue is full
+        bool                                tryPush(T&& value);
+        // Returns false when the queue is empty
+        bool                                tryPop(T& value);
+
+        size_t                              getCapacity() const;
+
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t>             sequence;
+            T                               value;
+        };
+
+        std::unique_ptr<Cell[]>             mCells;
+        const size_t                        mCapacity;
+        const size_t                        mMask;
+        alignas(64) std::atomic<size_t>     mEnqueuePosition;
+        alignas(64) std::atomic<size_t>     mDequeuePosition;
+};
+
+
+template <typename T>
+MPMCQueue<T>::MPMCQueue(size_t capacity)
+: mCells(new Cell[roundUpToPowerOfTwo(capacity)])
+, mCapacity(roundUpToPowerOfTwo(capacity))
+, mMask(mCapacity - 1u)
+, mEnqueuePosition(0u)
+, mDequeuePosition(0u)
+{
+    for (size_t i = 0; i < mCapacity; ++i)
+        mCells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool MPMCQueue<T>::tryPush(T&& value)
+{
+    auto position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& cell = mCells[position & mMask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = (ptrdiff_t) sequence - (ptrdiff_t) position;
+        if (difference == 0)
+        {
+            if (mEnqueuePosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+            {
+                cell.value = std::move(value);
+                cell.sequence.store(position + 1u, std::memory_order_release);
+                return true;
+            }
+        }
+        // The cell still holds last lap's value: full
+        else if (difference < 0)
+            return false;
+        else
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool MPMCQueue<T>::tryPop(T& value)
+{
+    auto position = mDequeuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& cell = mCells[position & mMask];
+        auto sequence = cell.sequence.load(std::memory_order_acquire);
+        auto difference = (ptrdiff_t) sequence - (ptrdiff_t) (position + 1u);
+        if (difference == 0)
+        {
+            if (mDequeuePosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed))
+            {
+                value = std::move(cell.value);
+                cell.value = T();
+                cell.sequence.store(position + mCapacity, std::memory_order_release);
+                return true;
+            }
+        }
+        // The cell has not been written this lap: empty
+        else if (difference < 0)
+            return false;
+        else
+            position = mDequeuePosition.load(std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+size_t MPMCQueue<T>::getCapacity() const
+{
+    return mCapacity;
+}
+
+#endif // SV_MPMCQUEUE_HPP
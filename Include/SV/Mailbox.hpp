@@ -0,0 +1,85 @@
+#ifndef SV_MAILBOX_HPP
+#define SV_MAILBOX_HPP
+
+
+#include <atomic>
+#include <utility>
+
+
+/*
+Single-slot mailbox for exactly one writer thread and one reader thread: the reader always gets the newest value and
+the writer never waits. Lock-free triple buffer; a value the reader did not take in time is destroyed by the next post.
+*/
+template <typename T>
+class Mailbox
+{
+    public:
+                                            Mailbox();
+                                            Mailbox(const Mailbox&) = delete;
+        Mailbox&                            operator=(const Mailbox&) = delete;
+
+        // Writer side; returns true when it replaced a value the reader never took
+        bool                                post(T&& value);
+        // Reader side; returns false when nothing was posted since the last take
+        bool                                take(T& value);
+        // Writer side, with the reader stopped; drops the value not taken, if any
+        void                                clear();
+
+
+    private:
+        static const unsigned int           FRESH = 4u;
+        static const unsigned int           INDEX = 3u;
+
+
+    private:
+        T                                   mSlots[3];
+        // Index of the slot between writer and reader, FRESH while the reader has not taken it
+        alignas(64) std::atomic<unsigned int>   mMiddle;
+        // Owned by the writer
+        alignas(64) unsigned int            mBack;
+        // Owned by the reader
+        alignas(64) unsigned int            mFront;
+};
+
+
+template <typename T>
+Mailbox<T>::Mailbox()
+: mSlots()
+, mMiddle(0u)
+, mBack(1u)
+, mFront(2u)
+{
+}
+
+template <typename T>
+bool Mailbox<T>::post(T&& value)
+{
+    mSlots[mBack] = std::move(value);
+    auto previous = mMiddle.exchange(mBack | FRESH, std::memory_order_acq_rel);
+    mBack = previous & INDEX;
+    // Stale or already moved out by the reader; release what it holds now rather than on the next post
+    mSlots[mBack] = T();
+    return (previous & FRESH) != 0u;
+}
+
+template <typename T>
+bool Mailbox<T>::take(T& value)
+{
+    if ((mMiddle.load(std::memory_order_relaxed) & FRESH) == 0u)
+        return false;
+
+    auto previous = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+    mFront = previous & INDEX;
+    value = std::move(mSlots[mFront]);
+    return true;
+}
+
+template <typename T>
+void Mailbox<T>::clear()
+{
+    auto previous = mMiddle.exchange(mBack, std::memory_order_acq_rel);
+    mBack = previous & INDEX;
+    mSlots[mBack] = T();
+}
+
+#endif // SV_MAILBOX_HPP
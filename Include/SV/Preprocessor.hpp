@@ -0,0 +1,53 @@
+#ifndef SV_PREPROCESSOR_HPP
+#define SV_PREPROCESSOR_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/ImageProcessing.hpp>
+#include <SV/Rectifier.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+
+/*
+Gray conversion, Otsu binarization and rectification of one camera's frames, cut into horizontal bands of about
+bandSize bytes of gray image so each band stays in the L2 cache while a core works through it. Bands run on the
+cv::parallel_for_ pool, so one frame takes every core instead of one.
+Otsu needs the whole image before any pixel can be binarized, hence two passes: convert() converts each band and
+counts its histogram, threshold() adds the histograms up and searches them as cv::threshold does, rectify() fills each
+band of the rectified image. With nearest-neighbour maps (the default) rectify() binarizes on the fly the gray pixels
+its maps point at, and no binary image is written at all; interpolating maps need one, banded too.
+The three calls belong to one frame, in order; one Preprocessor serves one thread.
+*/
+class Preprocessor
+{
+    public:
+                                    Preprocessor(const Rectifier* rectifierPtr, size_t bandSize);
+
+        // Mono8 images are used in place: imageGray becomes a header over image, as with SV::convertToGray
+        void                        convert(const cv::Mat& image, SV::PixelFormat pixelFormat, bool binning, cv::Mat& imageGray);
+        // Otsu threshold of the last converted image
+        double                      threshold();
+        // binaryImage is scratch of the gray image's size, only written when the maps interpolate; rectifiedImage is
+        // allocated to the size of the maps if it is not already
+        void                        rectify(const cv::Mat& imageGray, double threshold, cv::Mat& binaryImage, cv::Mat& rectifiedImage);
+
+
+    private:
+        class ConvertBody;
+        class BinarizeBody;
+        class RectifyBody;
+
+        int                         getBands(const cv::Mat& image) const;
+
+
+    private:
+        const Rectifier*            mRectifierPtr;
+        size_t                      mBandSize;
+        // One per band of the last converted image
+        std::vector<SV::Histogram>  mHistograms;
+};
+
+#endif // SV_PREPROCESSOR_HPP
@@ -0,0 +1,51 @@
+#ifndef SV_PYLONFRAMESOURCE_HPP
+#define SV_PYLONFRAMESOURCE_HPP
+
+
+#include <SV/FrameSource.hpp>
+
+#include <pylon/TlFactory.h>
+#include <pylon/InstantCameraArray.h>
+
+#include <vector>
+#include <string>
+
+
+// Basler GigE cameras grabbed through the Pylon SDK
+class PylonFrameSource : public FrameSource
+{
+    public:
+                                    PylonFrameSource();
+
+        virtual void                open();
+        virtual void                close();
+        virtual bool                isOpen() const;
+
+        virtual void                startGrabbing();
+        virtual void                stopGrabbing();
+        virtual bool                isGrabbing() const;
+        virtual bool                retrieveFrame(SV::Frame& frame, unsigned int timeout);
+
+        virtual size_t              getNumberOfCameras() const;
+        virtual cv::Size            getImageSize(size_t camera) const;
+        virtual bool                isEmulated() const;
+        virtual bool                getStreamParameters(size_t camera, SV::StreamParameters& streamParameters) const;
+        virtual void                setTransportDelays(size_t camera, const SV::TransportDelays& transportDelays);
+
+
+    private:
+        void                        attachDevices();
+        void                        scheduleTransportDelays();
+
+
+    private:
+        Pylon::PylonAutoInitTerm    mAutoInitTerm;
+        Pylon::CTlFactory&          mTransportLayerFactory;
+        Pylon::DeviceInfoList_t     mDevices;
+        Pylon::CInstantCameraArray  mCameras;
+        bool                        mEmulated;
+        std::vector<cv::Size>       mImageSizes;
+        std::vector<SV::StreamParameters>   mStreamParameters;
+};
+
+#endif // SV_PYLONFRAMESOURCE_HPP
@@ -0,0 +1,76 @@
+#ifndef SV_RECORDINGFRAMESOURCE_HPP
+#define SV_RECORDINGFRAMESOURCE_HPP
+
+
+#include <SV/FrameSource.hpp>
+#include <SV/FrameRecording.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/*
+Replays a FrameRecorder recording from a read-only mapping of the whole file: frames are views of the mapping, never
+copied, and the mapping outlives close() for as long as any frame holds it through Frame::owner. The kernel reads
+ahead of the replay, so the pipeline sees raw frames at the speed of the page cache or the disk.
+REPLAY_REAL_TIME keeps the recorded spacing of the frames; REPLAY_FAST delivers them as fast as they are taken.
+*/
+class RecordingFrameSource : public FrameSource
+{
+    public:
+        enum ReplayMode
+        {
+            REPLAY_REAL_TIME,
+            REPLAY_FAST
+        };
+
+
+    public:
+                                            RecordingFrameSource(std::string recordingFile, ReplayMode replayMode, uint64_t firstFrame);
+
+        virtual void                        open();
+        virtual void                        close();
+        virtual bool                        isOpen() const;
+
+        virtual void                        startGrabbing();
+        virtual void                        stopGrabbing();
+        virtual bool                        isGrabbing() const;
+        virtual bool                        retrieveFrame(SV::Frame& frame, unsigned int timeout);
+
+        virtual size_t                      getNumberOfCameras() const;
+        virtual cv::Size                    getImageSize(size_t camera) const;
+
+        // Next frame delivered, in recording order; real-time replay continues from there
+        void                                seek(uint64_t frame);
+        uint64_t                            getNumberOfFrames() const;
+
+
+    private:
+        // Rebuilds the index of a recording that was never closed
+        void                                scanChunks(uint64_t mappingSize);
+        void                                prefetch(uint64_t frame);
+
+
+    private:
+        std::string                         mRecordingFile;
+        ReplayMode                          mReplayMode;
+        uint64_t                            mFirstFrame;
+        // Shared with the frames in flight
+        std::shared_ptr<unsigned char>      mMapping;
+        size_t                              mNumberOfCameras;
+        std::vector<SV::RecordedFrame>      mIndex;
+        bool                                mGrabbing;
+        uint64_t                            mNextFrame;
+        // Frames up to here were handed to the kernel read-ahead
+        uint64_t                            mPrefetched;
+        // Real-time replay: host time of the recording mapped to the replay clock
+        bool                                mClockStarted;
+        uint64_t                            mClockHostTime;
+        std::chrono::steady_clock::time_point   mClockStart;
+};
+
+#endif // SV_RECORDINGFRAMESOURCE_HPP
@@ -0,0 +1,51 @@
+#ifndef SV_RECTIFIER_HPP
+#define SV_RECTIFIER_HPP
+
+
+#include <SV/Utility.hpp>
+#include <SV/CalibrationBundle.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+/*
+Rectification (cv::remap) of one camera with the maps of a CalibrationBundle.
+Fixed-point maps are the packed form of cv::convertMaps: 16-bit integer coordinates (mxy),
+a 5+5 bit interpolation table index (mtab) for bilinear remap, and rounded coordinates (mxynn)
+for nearest-neighbour remap. They halve the map bandwidth of the float maps (mx, my) and run on
+OpenCV's integer kernels; coordinates are quantised to 1/32 pixel (error <= 1/64 pixel).
+*/
+class Rectifier
+{
+    public:
+                                                            Rectifier(std::shared_ptr<const CalibrationBundle> calibrationBundle, size_t camera, SV::RemapMode remapMode, int interpolation);
+
+        void                                                rectify(const cv::Mat& image, cv::Mat& rectifiedImage) const;
+        // Rows [firstRow, lastRow) of rectify(), into a rectifiedImage already of getSize(); bands can run in parallel
+        void                                                rectifyRows(const cv::Mat& image, cv::Mat& rectifiedImage, int firstRow, int lastRow) const;
+        // Rows of rectify() applied to the binarization image > threshold, read through a table instead of a binary
+        // image; nearest-neighbour maps only
+        void                                                rectifyThresholdedRows(const cv::Mat& image, double threshold, cv::Mat& rectifiedImage, int firstRow, int lastRow) const;
+        cv::Size                                            getSize() const;
+        SV::RemapMode                                       getRemapMode() const;
+        int                                                 getInterpolation() const;
+
+        // Fixed-point maps named with the camera suffix ("1" or "2"), as stored in the bundle
+        static std::vector<CalibrationBundle::NamedMatrix>  createFixedPointMaps(const cv::Mat& mx, const cv::Mat& my, const std::string& suffix);
+        // Largest coordinate error (pixels) of the bilinear fixed-point maps over the map domain
+        static double                                       measureFixedPointError(const cv::Mat& mx, const cv::Mat& my, const cv::Mat& mxy, const cv::Mat& mtab);
+
+
+    private:
+        std::shared_ptr<const CalibrationBundle>            mCalibrationBundle;
+        SV::RemapMode                                       mRemapMode;
+        int                                                 mInterpolation;
+        cv::Mat                                             mMap1;
+        cv::Mat                                             mMap2;
+};
+
+#endif // SV_RECTIFIER_HPP
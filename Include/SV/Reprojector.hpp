@@ -0,0 +1,59 @@
+#ifndef SV_REPROJECTOR_HPP
+#define SV_REPROJECTOR_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+
+namespace SV
+{
+    // Organised point cloud: one CV_32FC1 plane per coordinate, same size as the disparity map; NaN where there is no depth
+    struct PointCloud
+    {
+        cv::Mat                             x;
+        cv::Mat                             y;
+        cv::Mat                             z;
+    };
+}
+
+/*
+Dense reprojection of fixed-point disparity maps (CV_16SC1 in 1/16 pixel, see DisparityEngine) to organised point clouds.
+Q of stereoRectify only mixes x into X, y into Y and d into W, so each disparity value has a fixed depth and 1/W:
+both come from a table indexed by the raw disparity, and X, Y are a per-column and a per-row term scaled by 1/W.
+Invalid, zero and out of range disparities index the last table entry, which holds NaN, so nothing branches per pixel.
+Disparities follow cv::reprojectImageTo3D: d = xLeft - xRight.
+Row bands are processed in parallel with cv::parallel_for_.
+*/
+class Reprojector
+{
+    public:
+        // 0 bands uses one per hardware thread
+                                            Reprojector(const cv::Mat& Q, int numberOfDisparities, int bands);
+
+        // Allocates the planes of cloud unless they already fit
+        void                                reproject(const cv::Mat& disparity, SV::PointCloud& cloud);
+
+
+    private:
+        class BandBody;
+
+        void                                reprojectRows(const cv::Mat& disparity, SV::PointCloud& cloud, int firstRow, int lastRow) const;
+
+
+    private:
+        int                                 mBands;
+        // Indexed by the fixed-point disparity, clamped to the last (invalid) entry
+        std::vector<float>                  mInverseW;
+        std::vector<float>                  mDepth;
+        // X = (Q00 x + Q03) / W, Y = (Q11 y + Q13) / W
+        float                               mXScale;
+        float                               mXOffset;
+        float                               mYScale;
+        float                               mYOffset;
+        // Q00 x + Q03 for the columns of the last disparity map
+        std::vector<float>                  mColumnX;
+};
+
+#endif // SV_REPROJECTOR_HPP
@@ -0,0 +1,110 @@
+#ifndef SV_SPSCQUEUE_HPP
+#define SV_SPSCQUEUE_HPP
+
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+
+/*
+Bounded lock-free ring for exactly one producer thread and one consumer thread.
+Capacity is rounded up to a power of two. Each side keeps a cached copy of the other
+side's index so the shared cache lines are only touched when the ring looks full or empty.
+*/
+template <typename T>
+class SPSCQueue
+{
+    public:
+        explicit                            SPSCQueue(size_t capacity);
+                                            SPSCQueue(const SPSCQueue&) = delete;
+        SPSCQueue&                          operator=(const SPSCQueue&) = delete;
+
+        // Producer side; returns false when the ring is full
+        bool                                tryPush(T&& value);
+        // Consumer side; returns false when the ring is empty
+        bool                                tryPop(T& value);
+
+        size_t                              getCapacity() const;
+        // Approximate when called concurrently with push or pop
+        size_t                              getSize() const;
+
+
+    private:
+        std::vector<T>                      mSlots;
+        const size_t                        mMask;
+        alignas(64) std::atomic<size_t>     mHead;
+        size_t                              mCachedTail;
+        alignas(64) std::atomic<size_t>     mTail;
+        size_t                              mCachedHead;
+};
+
+
+namespace
+{
+    inline size_t roundUpToPowerOfTwo(size_t value)
+    {
+        size_t powerOfTwo = 1u;
+        while (powerOfTwo < value)
+            powerOfTwo <<= 1;
+        return powerOfTwo;
+    }
+}
+
+template <typename T>
+SPSCQueue<T>::SPSCQueue(size_t capacity)
+: mSlots(roundUpToPowerOfTwo(capacity))
+, mMask(mSlots.size() - 1u)
+, mHead(0u)
+, mCachedTail(0u)
+, mTail(0u)
+, mCachedHead(0u)
+{
+}
+
+template <typename T>
+bool SPSCQueue<T>::tryPush(T&& value)
+{
+    auto tail = mTail.load(std::memory_order_relaxed);
+    if (tail - mCachedHead == mSlots.size())
+    {
+        mCachedHead = mHead.load(std::memory_order_acquire);
+        if (tail - mCachedHead == mSlots.size())
+            return false;
+    }
+    mSlots[tail & mMask] = std::move(value);
+    mTail.store(tail + 1u, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool SPSCQueue<T>::tryPop(T& value)
+{
+    auto head = mHead.load(std::memory_order_relaxed);
+    if (head == mCachedTail)
+    {
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if (head == mCachedTail)
+            return false;
+    }
+    // Move out and reset the slot so it does not pin resources (e.g. driver buffers) while idle
+    value = std::move(mSlots[head & mMask]);
+    mSlots[head & mMask] = T();
+    mHead.store(head + 1u, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+size_t SPSCQueue<T>::getCapacity() const
+{
+    return mSlots.size();
+}
+
+template <typename T>
+size_t SPSCQueue<T>::getSize() const
+{
+    return mTail.load(std::memory_order_acquire) - mHead.load(std::memory_order_acquire);
+}
+
+#endif // SV_SPSCQUEUE_HPP
@@ -0,0 +1,106 @@
+#ifndef SV_SHAREDFRAMERING_HPP
+#define SV_SHAREDFRAMERING_HPP
+
+
+#include <SV/Frame.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+#include <cstdint>
+
+
+namespace SV
+{
+    // Rectified stereo pair as read back from a SharedFrameRing
+    struct SharedFrame
+    {
+        SharedFrame()
+        : left()
+        , right()
+        , id(0u)
+        , timestamp(0u)
+        , calibrationVersion(0u)
+        , sequence(0u)
+        {
+        }
+
+        cv::Mat                             left;
+        cv::Mat                             right;
+        uint64_t                            id;
+        uint64_t                            timestamp;
+        // CalibrationBundle::getChecksum() of the calibration that rectified the pair
+        uint64_t                            calibrationVersion;
+        // Position in the ring's stream of published pairs, from 0
+        uint64_t                            sequence;
+    };
+}
+
+/*
+POSIX shared-memory ring of rectified stereo pairs, published by the capture process to any number of local readers.
+Layout: Header | Slot[slots], each slot a 64-byte SlotHeader followed by the left and right images (64-byte aligned rows).
+Each slot is a sequence lock: the writer makes its sequence odd, copies the pair in, then stores 2 * (n + 1) for pair n
+and bumps the header's published count. Readers copy a slot out and keep it only if the sequence was even, matched the pair
+they wanted and did not move meanwhile. The writer never waits for readers; a reader that falls a whole ring behind
+skips ahead and counts the pairs it lost.
+The geometry is fixed by the first published pair; pairs of another size or type are not published.
+*/
+class SharedFrameWriter
+{
+    public:
+        // name is a shm_open name ("/StereoVision"); an existing ring of that name is replaced
+                                            SharedFrameWriter(const std::string& name, size_t slots, uint64_t calibrationVersion);
+                                            ~SharedFrameWriter();
+                                            SharedFrameWriter(const SharedFrameWriter&) = delete;
+        SharedFrameWriter&                  operator=(const SharedFrameWriter&) = delete;
+
+        // Must be called from one thread
+        void                                publish(const SV::Frame& left, const SV::Frame& right);
+        uint64_t                            getPublished() const;
+        uint64_t                            getRejected() const;
+
+
+    private:
+        void                                create(cv::Size imageSize, int type);
+
+
+    private:
+        std::string                         mName;
+        size_t                              mSlots;
+        uint64_t                            mCalibrationVersion;
+        unsigned char*                      mMapping;
+        size_t                              mMappingSize;
+        uint64_t                            mPublished;
+        uint64_t                            mRejected;
+};
+
+class SharedFrameReader
+{
+    public:
+        // Throws when no ring of that name is published yet
+        explicit                            SharedFrameReader(const std::string& name);
+                                            ~SharedFrameReader();
+                                            SharedFrameReader(const SharedFrameReader&) = delete;
+        SharedFrameReader&                  operator=(const SharedFrameReader&) = delete;
+
+        // Next pair after the last one read (the oldest still in the ring after falling behind); false when there is none yet
+        bool                                readNext(SV::SharedFrame& frame);
+        // Newest pair, if it was not read already
+        bool                                readLatest(SV::SharedFrame& frame);
+        // Pairs overwritten before this reader got to them
+        uint64_t                            getDropped() const;
+        cv::Size                            getImageSize() const;
+
+
+    private:
+        bool                                read(uint64_t sequence, SV::SharedFrame& frame);
+
+
+    private:
+        unsigned char*                      mMapping;
+        size_t                              mMappingSize;
+        uint64_t                            mNext;
+        uint64_t                            mDropped;
+};
+
+#endif // SV_SHAREDFRAMERING_HPP
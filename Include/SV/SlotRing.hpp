@@ -0,0 +1,51 @@
+#ifndef SV_SLOTRING_HPP
+#define SV_SLOTRING_HPP
+
+
+#include <SV/MPMCQueue.hpp>
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+
+/*
+Fixed set of buffer slots lent to frames travelling down the pipeline. A slot is held by an owner (Frame::owner) and
+comes back to the ring, from any thread, when the last copy of that owner is dropped. The control block of each
+slot's owner lives in storage reserved with the ring, so lending a slot never touches the heap.
+*/
+class SlotRing
+{
+    public:
+        explicit                            SlotRing(size_t slots);
+                                            SlotRing(const SlotRing&) = delete;
+        SlotRing&                           operator=(const SlotRing&) = delete;
+
+        // Returns false when every slot is in flight
+        bool                                tryAcquire(size_t& slot, std::shared_ptr<void>& owner);
+
+        size_t                              getSlots() const;
+        size_t                              getFreeSlots() const;
+
+
+    private:
+        template <typename T>
+        class OwnerAllocator;
+
+        // Room for the control block of one owner
+        struct OwnerStorage
+        {
+            alignas(16) unsigned char       bytes[128];
+        };
+
+        void                                release(size_t slot);
+
+
+    private:
+        const size_t                        mSlots;
+        std::unique_ptr<OwnerStorage[]>     mOwnerStorage;
+        MPMCQueue<size_t>                   mFreeSlots;
+        std::atomic<size_t>                 mFreeSlotCount;
+};
+
+#endif // SV_SLOTRING_HPP
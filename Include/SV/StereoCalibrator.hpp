@@ -0,0 +1,117 @@
+#ifndef SV_STEREOCALIBRATOR_HPP
+#define SV_STEREOCALIBRATOR_HPP
+
+
+#include <SV/CalibrationBundle.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace SV
+{
+    // Calibration view of one camera; travels as the owner of the Frame pushed to the StereoSynchronizer
+    struct CalibrationView
+    {
+        cv::Mat                     image;
+        std::vector<cv::Point2f>    corners;
+    };
+}
+
+/*
+In-process stereo calibration, Bouguet's method as in the StereoCalibration module.
+Views are collected from the calibration loop with their corners already found; start() then runs
+stereoCalibrate, the epipolar quality check, stereoRectify and the rectification maps on a worker
+thread, so the cameras keep grabbing meanwhile. State and progress may be polled from any thread;
+cancel() takes effect at the next step boundary.
+*/
+class StereoCalibrator
+{
+    public:
+        enum State
+        {
+            STATE_COLLECTING,
+            STATE_RUNNING,
+            STATE_SUCCEEDED,
+            STATE_FAILED,
+            STATE_CANCELLED
+        };
+
+        enum Step
+        {
+            STEP_CALIBRATING,
+            STEP_CHECKING,
+            STEP_RECTIFYING,
+            STEP_MAPPING,
+            STEP_SAVING,
+            STEP_DONE
+        };
+
+        struct Report
+        {
+            size_t                              views;
+            cv::Size                            imageSize;
+            // RMS reprojection error of stereoCalibrate, pixels
+            double                              reprojectionError;
+            // Mean distance of the corners to their epipolar lines, pixels
+            double                              epipolarError;
+            // Worst fixed-point map error of both cameras, pixels
+            double                              fixedPointError;
+        };
+
+
+    public:
+                                                StereoCalibrator(cv::Size patternSize, float squareSize);
+                                                ~StereoCalibrator();
+                                                StereoCalibrator(const StereoCalibrator&) = delete;
+        StereoCalibrator&                       operator=(const StereoCalibrator&) = delete;
+
+        // Corners of both cameras in cv::findChessboardCorners order; ignored once start() was called
+        bool                                    addView(cv::Size imageSize, const std::vector<cv::Point2f>& cornersLeft, const std::vector<cv::Point2f>& cornersRight);
+        size_t                                  getNumberOfViews() const;
+
+        // Writes the calibration to xmlFilesPath (binary bundle and XML files) unless it is empty
+        void                                    start(const std::string& xmlFilesPath);
+        void                                    cancel();
+        // Blocks until the worker thread finished
+        void                                    wait();
+
+        State                                   getState() const;
+        bool                                    isCollecting() const;
+        bool                                    isFinished() const;
+        Step                                    getStep() const;
+        // Fraction of the steps done, 0 to 1
+        float                                   getProgress() const;
+        static std::string                      getStepName(Step step);
+
+        // Only valid in STATE_SUCCEEDED
+        std::shared_ptr<const CalibrationBundle> getCalibrationBundle() const;
+        Report                                  getReport() const;
+
+
+    private:
+        void                                    run(std::string xmlFilesPath);
+        // False when cancelled
+        bool                                    advance(Step step);
+
+
+    private:
+        cv::Size                                mPatternSize;
+        float                                   mSquareSize;
+        cv::Size                                mImageSize;
+        std::vector<std::vector<cv::Point2f>>   mCornersLeft;
+        std::vector<std::vector<cv::Point2f>>   mCornersRight;
+        std::atomic<int>                        mState;
+        std::atomic<int>                        mStep;
+        std::atomic<bool>                       mCancelled;
+        std::thread                             mThread;
+        std::shared_ptr<const CalibrationBundle> mCalibrationBundle;
+        Report                                  mReport;
+};
+
+#endif // SV_STEREOCALIBRATOR_HPP
@@ -0,0 +1,137 @@
+#ifndef SV_STEREOPIPELINE_HPP
+#define SV_STEREOPIPELINE_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/FrameHandler.hpp>
+#include <SV/FrameBufferPool.hpp>
+#include <SV/SPSCQueue.hpp>
+#include <SV/MPMCQueue.hpp>
+#include <SV/SlotRing.hpp>
+#include <SV/Mailbox.hpp>
+#include <SV/StereoSynchronizer.hpp>
+#include <SV/DisparityEngine.hpp>
+#include <SV/Reprojector.hpp>
+#include <SV/SharedFrameRing.hpp>
+#include <SV/Instrumentation.hpp>
+#include <SV/CornerTracker.hpp>
+#include <SV/Triangulation.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace SV
+{
+    // A rectified stereo pair travelling through the match, detect, triangulate and present stages
+    struct StereoFrame
+    {
+        StereoFrame()
+        : left()
+        , right()
+        , disparity()
+        , cloud()
+        , cornersLeft()
+        , cornersRight()
+        , foundLeft(false)
+        , foundRight(false)
+        , points()
+        {
+        }
+
+        Frame                       left;
+        Frame                       right;
+        // Dense disparity of the pair (CV_16SC1, see DisparityEngine); empty when disabled or skipped
+        Frame                       disparity;
+        // Organised cloud of the disparity map; its planes live in the disparity slot, so disparity.owner keeps them alive
+        PointCloud                  cloud;
+        std::vector<cv::Point2f>    cornersLeft;
+        std::vector<cv::Point2f>    cornersRight;
+        bool                        foundLeft;
+        bool                        foundRight;
+        Points3D                    points;
+    };
+}
+
+/*
+Capture pipeline of one stereo pair: grab (StereoRig) -> convert/threshold/rectify (one thread per camera) -> pair
+(StereoSynchronizer) (and publish to other processes, optional) -> match (dense disparity and point cloud, optional)
+-> detect (worker pool, or one corner tracking thread) -> triangulate -> present. Stages are connected by bounded
+lock-free queues and wait for room when the next stage falls behind, so back pressure reaches the frame source (Pylon
+grabs with GrabStrategy_UpcomingImage and simply skips the images nobody asked for). Camera 0 is the left camera of
+the pair and camera 1 the right one. The present stage is the exception: it runs on the caller's thread, since HighGUI
+windows belong to the main thread, and takes the newest pair from a single-slot mailbox, so a slow display drops pairs
+instead of slowing the pipeline down. Headless pipelines have no present stage and open no windows.
+*/
+class StereoPipeline
+{
+    public:
+                                                    StereoPipeline(std::string name, std::vector<std::string> cameraNames, cv::Size patternSize, cv::Mat Q, unsigned int detectWorkers, SharedFrameWriter* sharedFrameWriterPtr, bool headless);
+                                                    ~StereoPipeline();
+                                                    StereoPipeline(const StereoPipeline&) = delete;
+        StereoPipeline&                             operator=(const StereoPipeline&) = delete;
+
+        // The handlers run the preprocessing stage and hand their results back through submitRectified()
+        void                                        start(std::vector<FrameHandler*> cameraHandlers);
+        void                                        stop();
+        const std::string&                          getName() const;
+
+        // Grab stage output; waits for room when wait is set, otherwise returns false and drops the frame
+        bool                                        submitGrabbed(size_t camera, SV::Frame&& frame, bool wait);
+        // Preprocessing stage output; frame.image is the rectified image and frame.owner holds its buffer
+        void                                        submitRectified(SV::Frame&& frame);
+        // Draws and shows the newest stereo frame; returns false if none arrived within timeout milliseconds
+        bool                                        present(unsigned int timeout);
+        // Stage timers and frame counters; shared with the preprocessing handlers
+        Instrumentation*                            getInstrumentation();
+        // Seconds per frame of the slowest thread over the last instrumentation dump; 0 before the first one
+        double                                      getProcessingPeriod() const;
+
+
+    private:
+        void                                        preprocess(size_t camera);
+        void                                        pair();
+        void                                        match();
+        void                                        detect();
+        void                                        track();
+        void                                        triangulate();
+        void                                        allocateDisplayBuffers(cv::Size imageSize);
+        void                                        allocateDisparityBuffers(cv::Size imageSize);
+
+
+    private:
+        std::string                                 mName;
+        std::vector<std::string>                    mCameraNames;
+        bool                                        mHeadless;
+        cv::Size                                    mPatternSize;
+        cv::Mat                                     mQ;
+        unsigned int                                mDetectWorkers;
+        std::vector<FrameHandler*>                  mCameraHandlers;
+        std::atomic<bool>                           mRunning;
+        std::vector<std::unique_ptr<SPSCQueue<SV::Frame>>>  mGrabbedQueues;
+        MPMCQueue<SV::Frame>                        mRectifiedQueue;
+        MPMCQueue<SV::StereoFrame>                  mPairedQueue;
+        MPMCQueue<SV::StereoFrame>                  mMatchedQueue;
+        MPMCQueue<SV::StereoFrame>                  mDetectedQueue;
+        Mailbox<SV::StereoFrame>                    mDisplayMailbox;
+        StereoSynchronizer                          mStereoSynchronizer;
+        SharedFrameWriter*                          mSharedFrameWriterPtr;
+        std::unique_ptr<DisparityEngine>            mDisparityEngine;
+        std::unique_ptr<Reprojector>                mReprojector;
+        cv::Size                                    mDisparitySize;
+        FrameBufferPool                             mDisparityBufferPool;
+        SlotRing                                    mDisparitySlotRing;
+        std::vector<CornerTracker>                  mCornerTrackers;
+        std::vector<std::thread>                    mThreads;
+        uint64_t                                    mNewestId;
+        cv::Size                                    mDisplaySize;
+        FrameBufferPool                             mDisplayBufferPool;
+        Instrumentation                             mInstrumentation;
+};
+
+#endif // SV_STEREOPIPELINE_HPP
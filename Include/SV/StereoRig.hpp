@@ -0,0 +1,62 @@
+#ifndef SV_STEREORIG_HPP
+#define SV_STEREORIG_HPP
+
+
+#include <SV/FrameSource.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+class StereoPipeline;
+
+/*
+Stereo pairs sharing one frame source, each processed by its own StereoPipeline and worker threads.
+The grab thread is the only one touching the frame source: it routes the frames of every camera to the pipeline of
+their pair, renumbered 0 (left) and 1 (right). One pair keeps the back pressure to the frame source; with several
+pairs a busy one drops its frames instead, so it never stalls the others.
+*/
+class StereoRig
+{
+    public:
+                                            StereoRig();
+                                            ~StereoRig();
+                                            StereoRig(const StereoRig&) = delete;
+        StereoRig&                          operator=(const StereoRig&) = delete;
+
+        // left and right: cameras of the frame source; the pipeline must be started separately
+        void                                addPair(StereoPipeline* stereoPipelinePtr, size_t left, size_t right);
+
+        void                                start(FrameSource* frameSource);
+        // Stop before the pipelines, so no frame arrives at a stopped pipeline
+        void                                stop();
+        // False once the frame source stopped delivering frames
+        bool                                isRunning() const;
+
+        const std::vector<StereoPipeline*>& getPipelines() const;
+
+
+    private:
+        struct Route
+        {
+            StereoPipeline*                 pipeline;
+            size_t                          camera;
+        };
+
+
+    private:
+        void                                grab();
+
+
+    private:
+        std::vector<StereoPipeline*>        mPipelines;
+        // Indexed by frame source camera; cameras outside every pair have no pipeline
+        std::vector<Route>                  mRoutes;
+        FrameSource*                        mFrameSource;
+        std::atomic<bool>                   mRunning;
+        std::atomic<bool>                   mGrabbing;
+        std::thread                         mThread;
+};
+
+#endif // SV_STEREORIG_HPP
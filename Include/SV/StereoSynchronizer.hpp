@@ -0,0 +1,69 @@
+#ifndef SV_STEREOSYNCHRONIZER_HPP
+#define SV_STEREOSYNCHRONIZER_HPP
+
+
+#include <SV/Frame.hpp>
+#include <SV/Utility.hpp>
+
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+
+/*
+Matches left and right frames by frame ID or hardware timestamp (see SV::SynchronizationMode).
+A frame waits for its partner until a newer frame of the other camera proves it can no longer
+arrive within the skew window; frames that never find a partner are dropped as orphans.
+Frame IDs of free-running cameras are independent counters that drift apart when one camera starts late or skips an
+ID. When frames keep coming without a pair, the IDs are realigned on the newest frame of each camera.
+Pairs come out in capture order. push() must only be called from one thread at a time;
+the statistics may be read from any thread.
+*/
+class StereoSynchronizer
+{
+    public:
+        struct Statistics
+        {
+            uint64_t                        pairs;
+            uint64_t                        orphans;
+            uint64_t                        maximumSkew;
+            double                          meanSkew;
+            uint64_t                        realignments;
+        };
+
+
+    public:
+                                            StereoSynchronizer(SV::SynchronizationMode synchronizationMode, uint64_t maximumSkew, size_t depth);
+
+        // True when frame completes a pair; left and right then hold the matched frames
+        bool                                push(SV::Frame&& frame, SV::Frame& left, SV::Frame& right);
+        // Drops every waiting frame, e.g. when grabbing stops
+        void                                clear();
+        Statistics                          getStatistics() const;
+
+
+    private:
+        uint64_t                            getKey(const SV::Frame& frame) const;
+        void                                dropFront(std::vector<SV::Frame>& pending, size_t count);
+        // Frame ID mode: offsets the IDs of one camera so the newest waiting frames of both pair up
+        void                                realign();
+
+
+    private:
+        SV::SynchronizationMode             mSynchronizationMode;
+        uint64_t                            mMaximumSkew;
+        size_t                              mDepth;
+        std::array<std::vector<SV::Frame>, 2>   mPending;
+        // Added to the frame IDs of each camera
+        std::array<uint64_t, 2>             mIdOffsets;
+        // Frames pushed since the last pair
+        size_t                              mUnpaired;
+        std::atomic<uint64_t>               mPairs;
+        std::atomic<uint64_t>               mOrphans;
+        std::atomic<uint64_t>               mSkewSum;
+        std::atomic<uint64_t>               mSkewMaximum;
+        std::atomic<uint64_t>               mRealignments;
+};
+
+#endif // SV_STEREOSYNCHRONIZER_HPP
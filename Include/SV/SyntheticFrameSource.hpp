@@ -0,0 +1,105 @@
+#ifndef SV_SYNTHETICFRAMESOURCE_HPP
+#define SV_SYNTHETICFRAMESOURCE_HPP
+
+
+#include <SV/FrameSource.hpp>
+#include <SV/CalibrationBundle.hpp>
+
+#include <opencv2/core/core.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+
+/*
+Virtual stereo rig: two ideal pinhole cameras, already rectified, watching a chessboard that moves through a cycle of
+poses. Every pose is rendered once on open(), at any resolution and in Mono8 or BayerGB8, so grabbing costs nothing
+but the pipeline. The rig's calibration is known exactly, and so are the corners and depth of every frame, for
+accuracy checks under load.
+*/
+class SyntheticFrameSource : public FrameSource
+{
+    public:
+        struct Parameters
+        {
+            Parameters(cv::Size size, cv::Size pattern, float square)
+            : imageSize(size)
+            , patternSize(pattern)
+            , squareSize(square)
+            , focalLength(0.)
+            , baseline(10.)
+            , distance(0.)
+            , frameRate(0.)
+            , pixelFormat(SV::PIXEL_FORMAT_MONO8)
+            , poses(16u)
+            {
+            }
+
+            cv::Size            imageSize;
+            // Inner corners, as given to the chessboard detector
+            cv::Size            patternSize;
+            // Square side; baseline, distance and the ground truth depth are in the same unit
+            float               squareSize;
+            // Pixels; 0 takes the image width, a 53 degree horizontal field of view
+            double              focalLength;
+            double              baseline;
+            // Of the board from the left camera; 0 fills about half of the image width with the board
+            double              distance;
+            // Pairs per second; 0 delivers them as fast as they are taken
+            double              frameRate;
+            // PIXEL_FORMAT_MONO8 or PIXEL_FORMAT_BAYERGB8
+            SV::PixelFormat     pixelFormat;
+            // Rendered poses, replayed in a loop; each costs two images of memory
+            size_t              poses;
+        };
+
+        // Of one pose; corners are in the order of the chessboard detector, row by row
+        struct GroundTruth
+        {
+            std::vector<cv::Point2f>    cornersLeft;
+            std::vector<cv::Point2f>    cornersRight;
+            // Left camera coordinates; z is the depth
+            std::vector<cv::Point3f>    corners;
+        };
+
+
+    public:
+        explicit                    SyntheticFrameSource(const Parameters& parameters);
+
+        virtual void                open();
+        virtual void                close();
+        virtual bool                isOpen() const;
+
+        virtual void                startGrabbing();
+        virtual void                stopGrabbing();
+        virtual bool                isGrabbing() const;
+        virtual bool                retrieveFrame(SV::Frame& frame, unsigned int timeout);
+
+        virtual size_t              getNumberOfCameras() const;
+        virtual cv::Size            getImageSize(size_t camera) const;
+        virtual std::shared_ptr<const CalibrationBundle>    getCalibrationBundle(size_t left, size_t right) const;
+
+        // Ground truth of the frames with this id
+        const GroundTruth&          getGroundTruth(uint64_t id) const;
+        const Parameters&           getParameters() const;
+
+
+    private:
+        void                        createCalibration();
+        void                        renderPose(size_t pose);
+
+
+    private:
+        Parameters                  mParameters;
+        std::vector<std::array<cv::Mat, 2>>     mImages;
+        std::vector<GroundTruth>    mGroundTruth;
+        std::shared_ptr<const CalibrationBundle>    mCalibrationBundle;
+        bool                        mOpen;
+        bool                        mGrabbing;
+        uint64_t                    mNextFrame;
+        std::chrono::steady_clock::time_point   mGrabStart;
+};
+
+#endif // SV_SYNTHETICFRAMESOURCE_HPP
@@ -0,0 +1,50 @@
+#ifndef SV_TRIANGULATION_HPP
+#define SV_TRIANGULATION_HPP
+
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+#include <cstddef>
+
+
+namespace SV
+{
+    /* Structures */
+    // Points in structure-of-arrays layout, so each coordinate streams through the SIMD lanes
+    struct Points2D
+    {
+        void                    resize(size_t size) { x.resize(size); y.resize(size); }
+        void                    clear() { x.clear(); y.clear(); }
+        size_t                  size() const { return x.size(); }
+        bool                    empty() const { return x.empty(); }
+
+        std::vector<float>      x;
+        std::vector<float>      y;
+    };
+
+    struct Points3D
+    {
+        void                    resize(size_t size) { x.resize(size); y.resize(size); z.resize(size); }
+        void                    clear() { x.clear(); y.clear(); z.clear(); }
+        size_t                  size() const { return x.size(); }
+        bool                    empty() const { return x.empty(); }
+
+        std::vector<float>      x;
+        std::vector<float>      y;
+        std::vector<float>      z;
+    };
+
+
+    /* Functions */
+    // [X Y Z W] = Q [x y d 1], d = xLeft - xRight as in cv::reprojectImageTo3D and Reprojector, then divides by W;
+    // Q is the 4x4 reprojection matrix of stereoRectify
+    void                        triangulate(const cv::Mat& Q, const float* xLeft, const float* yLeft, const float* xRight,
+                                    float* X, float* Y, float* Z, size_t count);
+    void                        triangulate(const cv::Mat& Q, const Points2D& left, const Points2D& right, Points3D& points);
+
+    // Splits (x, y) pairs into arrays
+    void                        toPoints2D(const std::vector<cv::Point2f>& points, Points2D& arrays);
+}
+
+#endif // SV_TRIANGULATION_HPP
@@ -2,11 +2,16 @@
 #define SV_UTILITY_HPP
 
 
+#include <SV/CalibrationBundle.hpp>
+
 #include <opencv2/core/core.hpp>
 
 #include <string>
 #include <array>
+#include <vector>
+#include <memory>
 #include <utility>
+#include <cstdint>
 
 
 namespace SV
@@ -14,13 +19,84 @@ namespace SV
 	/* Camera Parameters */
     extern const int           	MAX_NUMBER_OF_CAMERAS;
     extern const char*         	CONFIGURATION_FILE;
-    extern int                 	MAIN_LOOP_ITERATION_TIME;
-    extern const int           	INTER_PACKET_DELAY;
-    extern const int           	FRAME_TRANSMISSION_DELAY;
+    extern const bool           BANDWIDTH_SCHEDULING;
+    extern const double         GIGE_LINK_BANDWIDTH;
+    extern const double         GIGE_SCHEDULE_MARGIN;
+    extern const double         GIGE_RESCHEDULE_THRESHOLD;
+    extern const size_t         GIGE_SWITCH_BUFFER;
+
+
+    /* Memory Parameters */
+    extern const bool           FRAME_BUFFER_HUGE_PAGES;
+
+
+    /* Image Processing Parameters */
+    extern const bool           BAYER_2X2_BINNING;
+    extern const int            CHESSBOARD_PYRAMID_LEVELS;
+    extern const size_t         PREPROCESSING_BAND_SIZE;
+
+
+    /* Pipeline Parameters */
+    extern const size_t         PIPELINE_QUEUE_CAPACITY;
+    extern const size_t         PIPELINE_FRAME_SLOTS;
+    extern const unsigned int   PIPELINE_DETECT_WORKERS;
+    extern const unsigned int   INSTRUMENTATION_DUMP_INTERVAL;
+    extern const unsigned int   DISPLAY_REFRESH_RATE;
+
+
+    /* Publishing Parameters */
+    extern const bool           SHARED_FRAME_RING;
+    extern const std::string    SHARED_FRAME_RING_NAME;
+    extern const size_t         SHARED_FRAME_RING_SLOTS;
+
+
+    /* Recording Parameters */
+    extern const size_t         RECORDING_CHUNK_SIZE;
+    extern const size_t         RECORDING_CHUNKS;
+
+
+    /* Corner Tracking Parameters */
+    extern const bool           CORNER_TRACKING;
+    extern const int            CORNER_TRACKING_WINDOW_SIZE;
+    extern const int            CORNER_TRACKING_PYRAMID_LEVELS;
+    extern const float          CORNER_TRACKING_MAXIMUM_ERROR;
+
+
+    /* Disparity Parameters */
+    extern const bool           DENSE_DISPARITY;
+    extern const int            DISPARITY_NUMBER;
+    extern const int            DISPARITY_WINDOW_SIZE;
+    extern const int            DISPARITY_TEXTURE_THRESHOLD;
+    extern const int            DISPARITY_LR_TOLERANCE;
+    extern const int            DISPARITY_BANDS;
+    extern const bool           DENSE_REPROJECTION;
+    extern const size_t         DISPARITY_SLOTS;
+
+
+    /* Synchronization Parameters */
+    enum SynchronizationMode
+    {
+        SYNCHRONIZE_BY_FRAME_ID,
+        SYNCHRONIZE_BY_TIMESTAMP
+    };
+
+    extern const SynchronizationMode    SYNCHRONIZATION_MODE;
+    extern const uint64_t       SYNCHRONIZATION_MAXIMUM_SKEW;
+    extern const size_t         SYNCHRONIZATION_DEPTH;
+
+
+    /* Rectification Parameters */
+    enum RemapMode
+    {
+        REMAP_FLOAT_MAPS,
+        REMAP_FIXED_POINT_MAPS
+    };
+
+    extern const RemapMode      REMAP_MODE;
+    extern const int            REMAP_INTERPOLATION;
 
     
     /* Calibration Parameters */
-    extern const std::string    CALIBRATION_BIN;
     extern const std::string	CALIBRATION_TIMESTAMP_FILE;
     extern const std::string    CALIBRATION_PATTERN_FILE;
     extern const std::string    CALIBRATION_XML_FILES_PATH;
@@ -29,6 +105,8 @@ namespace SV
     extern const std::string    CALIBRATION_IMAGE_LEFT;
     extern const std::string    CALIBRATION_IMAGE_RIGHT;
     extern const std::string	NOT_CALIBRATED;
+    extern const size_t         IMAGE_WRITER_QUEUE_CAPACITY;
+    extern const int            IMAGE_WRITER_PNG_COMPRESSION;
 
     struct CalibrationPattern
     {
@@ -43,13 +121,29 @@ namespace SV
         unsigned int    h;
         float           s;
     };
+    
+
+
+    /* Rig Parameters */
+    extern const std::string    RIG_FILE;
 
-    struct StereoPhoto
+    // Two cameras of the frame source processed as one stereo pair
+    struct RigPair
     {
-        std::array<std::string, 2>  cameras;
-        std::pair<cv::Mat, cv::Mat> matPair;
+        RigPair(const std::string& pairName, size_t leftCamera, size_t rightCamera, const std::string& pairCalibrationPath)
+        : name(pairName)
+        , left(leftCamera)
+        , right(rightCamera)
+        , calibrationPath(pairCalibrationPath)
+        {
+        }
+
+        std::string     name;
+        size_t          left;
+        size_t          right;
+        // Folder of the pair's XML files and binary calibration bundle
+        std::string     calibrationPath;
     };
-    
 
 
     /* Emulation Parameters */
@@ -69,7 +163,9 @@ namespace SV
     void                        saveCalibrationTimestampFile();
     CalibrationPattern          loadCalibrationPatternFile();
     void                        saveCalibrationPatternFile(unsigned int w, unsigned int h, float s);
-    int                         forkExecStereoCalibrationModule(unsigned int w, unsigned int h, float s);
+    std::shared_ptr<const CalibrationBundle> loadCalibrationBundle(const std::string& calibrationPath);
+    std::vector<RigPair>        loadRig(size_t numberOfCameras);
+    std::string                 getCameraName(const RigPair& rigPair, size_t camera);
     cv::Scalar                  openCVRandomColor(cv::RNG& rng);
 }
 
@@ -0,0 +1,40 @@
+#ifndef SV_VIDEOFRAMESOURCE_HPP
+#define SV_VIDEOFRAMESOURCE_HPP
+
+
+#include <SV/FrameSource.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <array>
+#include <string>
+
+
+// Replays a recorded stereo stream: one video file per camera, decoded with OpenCV
+class VideoFrameSource : public FrameSource
+{
+    public:
+                                            VideoFrameSource(std::string leftVideoFile, std::string rightVideoFile);
+
+        virtual void                        open();
+        virtual void                        close();
+        virtual bool                        isOpen() const;
+
+        virtual void                        startGrabbing();
+        virtual void                        stopGrabbing();
+        virtual bool                        isGrabbing() const;
+        virtual bool                        retrieveFrame(SV::Frame& frame, unsigned int timeout);
+
+        virtual size_t                      getNumberOfCameras() const;
+        virtual cv::Size                    getImageSize(size_t camera) const;
+
+
+    private:
+        std::array<std::string, 2>          mVideoFiles;
+        std::array<cv::VideoCapture, 2>     mVideos;
+        bool                                mGrabbing;
+        bool                                mFinished;
+        uint64_t                            mNextFrame;
+};
+
+#endif // SV_VIDEOFRAMESOURCE_HPP
@@ -0,0 +1,107 @@
+/*
+    Tries GigE transport delays on a simulated link, without cameras: the scheduled delays (BandwidthScheduler) against
+    no delays and the fixed delays StereoVision used before scheduling (GevSCPD 8192, GevSCFTD 4096 per camera index).
+    Every policy runs at the frame period of the schedule.
+
+    Usage: BandwidthSimulator [-c cameras] [-w W] [-h H] [-p packet size] [-t processing ms] [-d seconds] [-b switch buffer]
+        -c  cameras sharing the link (default 2)
+        -w  image width (default 2590, default_linux.pfs)
+        -h  image height (default 1942)
+        -p  GevSCPSPacketSize in bytes (default 1500)
+        -t  processing period of the pipeline in milliseconds; 0 schedules for the link alone (default 0)
+        -d  simulated seconds (default 10)
+        -b  switch buffer in bytes (default SV::GIGE_SWITCH_BUFFER)
+*/
+
+#include <SV/Utility.hpp>
+#include <SV/BandwidthScheduler.hpp>
+#include <SV/GigELinkSimulator.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+
+
+namespace
+{
+    // Delays configured by hand before the scheduler, in ticks
+    const int64_t FIXED_INTER_PACKET_DELAY = 8192;
+    const int64_t FIXED_FRAME_TRANSMISSION_DELAY = 4096;
+    // Frames a camera buffers while its link is busy (Basler ace GigE)
+    const size_t CAMERA_BUFFER_FRAMES = 2u;
+
+    void printStatistics(const std::string& policy, const std::vector<SV::TransportDelays>& delays, const GigELinkSimulator::Statistics& statistics)
+    {
+        std::printf("%s\n", policy.c_str());
+        for (size_t i = 0; i < delays.size(); ++i)
+        {
+            std::printf("  camera %zu  GevSCPD %8lld  GevSCFTD %8lld  %7.2f FPS  %8zu packets  %8zu dropped  %6zu incomplete  %6zu skipped\n",
+                        i, (long long) delays[i].interPacketDelay, (long long) delays[i].frameTransmissionDelay, statistics.frameRates[i],
+                        statistics.packets[i], statistics.droppedPackets[i], statistics.incompleteFrames[i], statistics.skippedFrames[i]);
+        }
+        std::printf("  switch backlog %zu bytes at most, %.2f ms mean latency\n", statistics.maximumBacklog, statistics.meanLatency * 1000.);
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    size_t cameras = 2u;
+    SV::StreamParameters streamParameters;
+    streamParameters.imageSize = cv::Size(2590, 1942);
+    double processingPeriod = 0.;
+    double duration = 10.;
+    size_t switchBuffer = SV::GIGE_SWITCH_BUFFER;
+
+    int option;
+    while ((option = getopt(argc, argv, "c:w:h:p:t:d:b:")) != -1)
+    {
+        switch (option)
+        {
+            case 'c': cameras = (size_t) std::atoi(optarg); break;
+            case 'w': streamParameters.imageSize.width = std::atoi(optarg); break;
+            case 'h': streamParameters.imageSize.height = std::atoi(optarg); break;
+            case 'p': streamParameters.packetSize = std::atoi(optarg); break;
+            case 't': processingPeriod = std::atof(optarg) / 1000.; break;
+            case 'd': duration = std::atof(optarg); break;
+            case 'b': switchBuffer = (size_t) std::atol(optarg); break;
+            default:
+                std::cerr << "Usage: " << argv[0] << " [-c cameras] [-w W] [-h H] [-p packet size] [-t processing ms] [-d seconds] [-b switch buffer]" << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        std::vector<SV::StreamParameters> streams(cameras, streamParameters);
+        BandwidthScheduler bandwidthScheduler(SV::GIGE_LINK_BANDWIDTH, SV::GIGE_SCHEDULE_MARGIN);
+        auto schedule = bandwidthScheduler.compute(streams, processingPeriod);
+        std::printf("%zu cameras, %dx%d, %zu packets per frame; link allows %.2f FPS, scheduled %.2f FPS\n\n",
+                    cameras, streamParameters.imageSize.width, streamParameters.imageSize.height,
+                    BandwidthScheduler::getPacketsPerFrame(streamParameters), 1. / schedule.linkPeriod, 1. / schedule.framePeriod);
+
+        std::vector<SV::TransportDelays> noDelays(cameras);
+        std::vector<SV::TransportDelays> fixedDelays(cameras);
+        for (size_t i = 0; i < cameras; ++i)
+        {
+            fixedDelays[i].interPacketDelay = FIXED_INTER_PACKET_DELAY;
+            fixedDelays[i].frameTransmissionDelay = FIXED_FRAME_TRANSMISSION_DELAY * (int64_t) (i + 1);
+        }
+
+        GigELinkSimulator gigELinkSimulator(SV::GIGE_LINK_BANDWIDTH, switchBuffer, CAMERA_BUFFER_FRAMES);
+        printStatistics("No delays", noDelays, gigELinkSimulator.run(streams, noDelays, schedule.framePeriod, duration));
+        printStatistics("Fixed delays", fixedDelays, gigELinkSimulator.run(streams, fixedDelays, schedule.framePeriod, duration));
+        printStatistics("Scheduled delays", schedule.delays, gigELinkSimulator.run(streams, schedule.delays, schedule.framePeriod, duration));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+/*
+    Example consumer of the shared-memory frame ring published by StereoVision in capture mode.
+    Usage: SharedFrameReader [ring name] [--latest] [--show]
+        ring name   shm_open name of the ring; default /StereoVision
+        --latest    skip to the newest pair instead of reading every pair in order
+        --show      display the pairs; otherwise only their metadata is printed
+*/
+
+#include <SV/SharedFrameRing.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <iostream>
+#include <stdexcept>
+
+
+int main(int argc, char** argv)
+{
+    std::string name = "/StereoVision";
+    bool latest = false;
+    bool show = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument(argv[i]);
+        if (argument == "--latest")
+            latest = true;
+        else if (argument == "--show")
+            show = true;
+        else
+            name = argument;
+    }
+
+    // The ring only exists once the capture process published its first pair
+    std::unique_ptr<SharedFrameReader> reader;
+    while (!reader)
+    {
+        try
+        {
+            reader.reset(new SharedFrameReader(name));
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << e.what() << "; retrying..." << std::endl;
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+    auto imageSize = reader->getImageSize();
+    std::cout << "Reading " << imageSize.width << "x" << imageSize.height << " pairs from " << name << ". Press ESC on a window or Ctrl+C to exit." << std::endl;
+
+    SV::SharedFrame frame;
+    uint64_t frames = 0u;
+    while (true)
+    {
+        if (!(latest ? reader->readLatest(frame) : reader->readNext(frame)))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        ++frames;
+        std::cout << "Pair " << frame.sequence << " >> id: " << frame.id << "; timestamp: " << frame.timestamp
+                  << "; calibration: " << std::hex << frame.calibrationVersion << std::dec
+                  << "; read: " << frames << "; dropped: " << reader->getDropped() << std::endl;
+
+        if (show)
+        {
+            cv::imshow("Shared Left", frame.left);
+            cv::imshow("Shared Right", frame.right);
+            if ((cv::waitKey(1) & 255) == 27)
+                break;
+        }
+    }
+
+    return 0;
+}
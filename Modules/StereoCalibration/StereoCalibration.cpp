@@ -35,27 +35,155 @@
 #include "cxmisc.h"
 #include "highgui.h"
 #include "cvaux.h"
+#include <SV/CalibrationBundle.hpp>
+#include <SV/Rectifier.hpp>
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <stdio.h>
 #include <stdlib.h>
 #include <ctype.h>
 
 using namespace std;
 
+//
+// Corners of one image of the list; filled in by the detection workers,
+// so every image can be searched on its own core.
+//
+struct ChessboardView
+{
+    ChessboardView() : loaded(false), result(0), count(0), imageSize(cvSize(0,0)), corners() {}
+
+    bool loaded;
+    int result;
+    int count;
+    CvSize imageSize;
+    vector<CvPoint2D32f> corners;
+};
+
+static void
+FindChessboardView(const string& imageName, int nx, int ny, int maxScale, ChessboardView& view)
+{
+    IplImage* img = cvLoadImage( imageName.c_str(), 0 );
+    if( !img )
+        return;
+    view.loaded = true;
+    view.imageSize = cvGetSize(img);
+    view.corners.resize(nx*ny);
+    for( int s = 1; s <= maxScale; s++ )
+    {
+        IplImage* timg = img;
+        if( s > 1 )
+        {
+            timg = cvCreateImage(cvSize(img->width*s,img->height*s),
+                img->depth, img->nChannels );
+            cvResize( img, timg, CV_INTER_CUBIC );
+        }
+        view.result = cvFindChessboardCorners( timg, cvSize(nx, ny),
+            &view.corners[0], &view.count,
+            CV_CALIB_CB_ADAPTIVE_THRESH |
+            CV_CALIB_CB_NORMALIZE_IMAGE);
+        if( timg != img )
+            cvReleaseImage( &timg );
+        if( view.result || s == maxScale )
+            for( int j = 0; j < view.count; j++ )
+        {
+            view.corners[j].x /= s;
+            view.corners[j].y /= s;
+        }
+        if( view.result )
+            break;
+    }
+    if( view.result )
+    {
+     //Calibration will suffer without subpixel interpolation
+        cvFindCornerSubPix( img, &view.corners[0], view.count,
+            cvSize(11, 11), cvSize(-1,-1),
+            cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS,
+            30, 0.01) );
+    }
+    cvReleaseImage( &img );
+}
+
+//
+// String as the body of a JSON string literal: quotes, backslashes and
+// control characters are escaped.
+//
+static string
+JsonEscape(const string& text)
+{
+    string escaped;
+    for( size_t i = 0; i < text.size(); i++ )
+    {
+        unsigned char c = (unsigned char)text[i];
+        if( c == '"' || c == '\\' )
+        {
+            escaped += '\\';
+            escaped += (char)c;
+        }
+        else if( c < 0x20 )
+        {
+            char code[8];
+            sprintf(code, "\\u%04x", c);
+            escaped += code;
+        }
+        else
+            escaped += (char)c;
+    }
+    return escaped;
+}
+
+//
+// Quality report of a calibration run as JSON, for scripted recalibration.
+// Per-view errors are the mean epipolar distance of the corners of each pair.
+//
+static void
+WriteReport(const char* reportPath, int nx, int ny, float squareSize, CvSize imageSize,
+    double rmsErr, double avgErr, const double* fixedPointErr,
+    const vector<string>* imageNames, const vector<uchar>* active, const vector<double>& viewErr)
+{
+    FILE* f = fopen(reportPath, "wt");
+    if( !f )
+    {
+        fprintf(stderr, "can not write report %s\n", reportPath );
+        return;
+    }
+    fprintf(f, "{\n");
+    fprintf(f, "  \"pattern\": {\"nx\": %d, \"ny\": %d, \"squareSize\": %g},\n", nx, ny, squareSize);
+    fprintf(f, "  \"imageSize\": {\"width\": %d, \"height\": %d},\n", imageSize.width, imageSize.height);
+    fprintf(f, "  \"rmsError\": %g,\n", rmsErr);
+    fprintf(f, "  \"epipolarError\": %g,\n", avgErr);
+    fprintf(f, "  \"fixedPointError\": [%g, %g],\n", fixedPointErr[0], fixedPointErr[1]);
+    fprintf(f, "  \"views\": [\n");
+    for( size_t i = 0; i < viewErr.size(); i++ )
+    {
+        fprintf(f, "    {\"left\": \"%s\", \"right\": \"%s\", \"found\": %s, \"epipolarError\": %g}%s\n",
+            JsonEscape(imageNames[0][i]).c_str(), i < imageNames[1].size() ? JsonEscape(imageNames[1][i]).c_str() : "",
+            active[0][i] && i < active[1].size() && active[1][i] ? "true" : "false",
+            viewErr[i], i + 1 < viewErr.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n");
+    fprintf(f, "}\n");
+    fclose(f);
+    printf("quality report written to %s\n", reportPath);
+}
+
 //
 // Given a list of chessboard images, the number of corners (nx, ny)
 // on the chessboards, and a flag: useCalibrated for calibrated (0) or
 // uncalibrated (1: use cvStereoCalibrate(), 2: compute fundamental
 // matrix separately) stereo. Calibrate the cameras and display the
-// rectified results along with the computed disparity images.
+// rectified results along with the computed disparity images, unless
+// headless: then nothing is shown and only the calibration files and
+// the quality report are written.
 //
 static void
-StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _squareSize, char* xmlFilesPath)
+StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _squareSize, char* xmlFilesPath, int headless)
 {
-    int displayCorners = 1;
-    int showUndistorted = 1;
+    int displayCorners = !headless;
+    int showUndistorted = !headless;
     bool isVerticalStereo = false;//OpenCV can handle left-right
                                       //or up-down camera arrangements
     const int maxScale = 1;
@@ -67,7 +195,6 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
     vector<CvPoint2D32f> points[2];
     vector<int> npoints;
     vector<uchar> active[2];
-    vector<CvPoint2D32f> temp(n);
     CvSize imageSize = {0,0};
     // ARRAY AND VECTOR STORAGE:
     double M1[3][3], M2[3][3], D1[5], D2[5];
@@ -90,12 +217,10 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
         fprintf(stderr, "can not open file %s\n", imageList );
         return;
     }
-    for(i=0;;i++)
+    vector<string> imageFiles;
+    for(;;)
     {
         char buf[1024];
-        int count = 0, result=0;
-        lr = i % 2;
-        vector<CvPoint2D32f>& pts = points[lr];
         if( !fgets( buf, sizeof(buf)-3, f ))
             break;
         size_t len = strlen(buf);
@@ -103,45 +228,45 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
             buf[--len] = '\0';
         if( buf[0] == '#')
             continue;
-        IplImage* img = cvLoadImage( buf, 0 );
-        if( !img )
-            break;
-        imageSize = cvGetSize(img);
-        imageNames[lr].push_back(buf);
-    //FIND CHESSBOARDS AND CORNERS THEREIN:
-        for( int s = 1; s <= maxScale; s++ )
+        imageFiles.push_back(buf);
+    }
+    fclose(f);
+//FIND CHESSBOARDS AND CORNERS THEREIN, ONE IMAGE PAIR PER TASK:
+    vector<ChessboardView> views(imageFiles.size());
+    size_t npairs = (imageFiles.size() + 1)/2;
+    atomic<size_t> nextPair(0);
+    unsigned int nworkers = max(1u, min(thread::hardware_concurrency(), (unsigned int)npairs));
+    vector<thread> workers;
+    for( unsigned int w = 0; w < nworkers; w++ )
+        workers.push_back(thread([&]()
         {
-            IplImage* timg = img;
-            if( s > 1 )
-            {
-                timg = cvCreateImage(cvSize(img->width*s,img->height*s),
-                    img->depth, img->nChannels );
-                cvResize( img, timg, CV_INTER_CUBIC );
-            }
-            result = cvFindChessboardCorners( timg, cvSize(nx, ny),
-                &temp[0], &count,
-                CV_CALIB_CB_ADAPTIVE_THRESH |
-                CV_CALIB_CB_NORMALIZE_IMAGE);
-            if( timg != img )
-                cvReleaseImage( &timg );
-            if( result || s == maxScale )
-                for( j = 0; j < count; j++ )
-            {
-                temp[j].x /= s;
-                temp[j].y /= s;
-            }
-            if( result )
-                break;
-        }
+            for( size_t p = nextPair++; p < npairs; p = nextPair++ )
+                for( size_t k = 2*p; k < min(2*p + 2, imageFiles.size()); k++ )
+                    FindChessboardView(imageFiles[k], nx, ny, maxScale, views[k]);
+        }));
+    for( size_t w = 0; w < workers.size(); w++ )
+        workers[w].join();
+//COLLECT THE RESULTS IN LIST ORDER:
+    for(i=0;i<(int)views.size();i++)
+    {
+        lr = i % 2;
+        vector<CvPoint2D32f>& pts = points[lr];
+        ChessboardView& view = views[i];
+        if( !view.loaded )
+            break;
+        imageSize = view.imageSize;
+        imageNames[lr].push_back(imageFiles[i]);
         if( displayCorners )
         {
-            printf("%s\n", buf);
+            printf("%s\n", imageFiles[i].c_str());
+            IplImage* img = cvLoadImage( imageFiles[i].c_str(), 0 );
             IplImage* cimg = cvCreateImage( imageSize, 8, 3 );
             cvCvtColor( img, cimg, CV_GRAY2BGR );
-            cvDrawChessboardCorners( cimg, cvSize(nx, ny), &temp[0],
-                count, result );
+            cvDrawChessboardCorners( cimg, cvSize(nx, ny), &view.corners[0],
+                view.count, view.result );
             cvShowImage( "corners", cimg );
             cvReleaseImage( &cimg );
+            cvReleaseImage( &img );
             if( cvWaitKey(0) == 27 ) //Allow ESC to quit
                 exit(-1);
         }
@@ -149,20 +274,11 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
             putchar('.');
         N = pts.size();
         pts.resize(N + n, cvPoint2D32f(0,0));
-        active[lr].push_back((uchar)result);
+        active[lr].push_back((uchar)view.result);
     //assert( result != 0 );
-        if( result )
-        {
-         //Calibration will suffer without subpixel interpolation
-            cvFindCornerSubPix( img, &temp[0], count,
-                cvSize(11, 11), cvSize(-1,-1),
-                cvTermCriteria(CV_TERMCRIT_ITER+CV_TERMCRIT_EPS,
-                30, 0.01) );
-            copy( temp.begin(), temp.end(), pts.begin() + N );
-        }
-        cvReleaseImage( &img );
+        if( view.result )
+            copy( view.corners.begin(), view.corners.end(), pts.begin() + N );
     }
-    fclose(f);
     printf("\n");
 // HARVEST CHESSBOARD 3D OBJECT POINT LIST:
     nframes = active[0].size();//Number of good chessboads found
@@ -187,7 +303,7 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
 // CALIBRATE THE STEREO CAMERAS
     printf("Running stereo calibration ...");
     fflush(stdout);
-    cvStereoCalibrate( &_objectPoints, &_imagePoints1,
+    double rmsErr = cvStereoCalibrate( &_objectPoints, &_imagePoints1,
         &_imagePoints2, &_npoints,
         &_M1, &_D1, &_M2, &_D2,
         imageSize, &_R, &_T, &_E, &_F,
@@ -219,6 +335,7 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
     cvComputeCorrespondEpilines( &_imagePoints1, 1, &_F, &_L1 );
     cvComputeCorrespondEpilines( &_imagePoints2, 2, &_F, &_L2 );
     double avgErr = 0;
+    vector<double> viewErr(nframes, 0.);
     for( i = 0; i < N; i++ )
     {
         double err = fabs(points[0][i].x*lines[1][i].x +
@@ -226,10 +343,11 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
             + fabs(points[1][i].x*lines[0][i].x +
             points[1][i].y*lines[0][i].y + lines[0][i].z);
         avgErr += err;
+        viewErr[i/n] += err/n;
     }
     printf( "avg err = %g\n", avgErr/(nframes*n) );
+    double fixedPointErr[2] = {0, 0};
 //COMPUTE AND DISPLAY RECTIFICATION
-    if( showUndistorted )
     {
         CvMat* mx1 = cvCreateMat( imageSize.height,
             imageSize.width, CV_32F );
@@ -240,15 +358,6 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
             imageSize.width, CV_32F );
         CvMat* my2 = cvCreateMat( imageSize.height,
             imageSize.width, CV_32F );
-        CvMat* img1r = cvCreateMat( imageSize.height,
-            imageSize.width, CV_8U );
-        CvMat* img2r = cvCreateMat( imageSize.height,
-            imageSize.width, CV_8U );
-        CvMat* disp = cvCreateMat( imageSize.height,
-            imageSize.width, CV_16S );
-        CvMat* vdisp = cvCreateMat( imageSize.height,
-            imageSize.width, CV_8U );
-        CvMat* pair;
         double R1[3][3], R2[3][3], P1[3][4], P2[3][4];
         CvMat _R1 = cvMat(3, 3, CV_64F, R1);
         CvMat _R2 = cvMat(3, 3, CV_64F, R2);
@@ -347,6 +456,25 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
             cvSave(pathMY1,my1);
             cvSave(pathMX2,mx2);
             cvSave(pathMY2,my2);
+
+    //Save binary bundle mapped by the capture, with fixed-point maps for cvRemap()
+            vector<CalibrationBundle::NamedMatrix> bundleMatrices;
+            bundleMatrices.push_back(CalibrationBundle::NamedMatrix("Q", cv::Mat(&_Q)));
+            bundleMatrices.push_back(CalibrationBundle::NamedMatrix("mx1", cv::Mat(mx1)));
+            bundleMatrices.push_back(CalibrationBundle::NamedMatrix("my1", cv::Mat(my1)));
+            bundleMatrices.push_back(CalibrationBundle::NamedMatrix("mx2", cv::Mat(mx2)));
+            bundleMatrices.push_back(CalibrationBundle::NamedMatrix("my2", cv::Mat(my2)));
+            vector<CalibrationBundle::NamedMatrix> fixedPointMaps1 = Rectifier::createFixedPointMaps(cv::Mat(mx1), cv::Mat(my1), "1");
+            vector<CalibrationBundle::NamedMatrix> fixedPointMaps2 = Rectifier::createFixedPointMaps(cv::Mat(mx2), cv::Mat(my2), "2");
+            fixedPointErr[0] = Rectifier::measureFixedPointError(cv::Mat(mx1), cv::Mat(my1), fixedPointMaps1[0].second, fixedPointMaps1[1].second);
+            fixedPointErr[1] = Rectifier::measureFixedPointError(cv::Mat(mx2), cv::Mat(my2), fixedPointMaps2[0].second, fixedPointMaps2[1].second);
+            printf( "fixed-point map err = %g, %g\n", fixedPointErr[0], fixedPointErr[1] );
+            bundleMatrices.insert(bundleMatrices.end(), fixedPointMaps1.begin(), fixedPointMaps1.end());
+            bundleMatrices.insert(bundleMatrices.end(), fixedPointMaps2.begin(), fixedPointMaps2.end());
+
+            strcpy(tmpPath, xmlFilesPath);
+            strcat(tmpPath, CalibrationBundle::FILE_NAME.c_str());
+            CalibrationBundle::saveBinaryFile(tmpPath, bundleMatrices);
         }
 //OR ELSE HARTLEY'S METHOD
         else if( useUncalibrated == 1 || useUncalibrated == 2 )
@@ -379,86 +507,107 @@ StereoCalib(const char* imageList, int nx, int ny, int useUncalibrated, float _s
         }
         else
             assert(0);
-        cvNamedWindow( "rectified", 1 );
+// PREVIEW ONLY: SKIPPED WHEN HEADLESS
+        if( showUndistorted )
+        {
+            CvMat* img1r = cvCreateMat( imageSize.height,
+                imageSize.width, CV_8U );
+            CvMat* img2r = cvCreateMat( imageSize.height,
+                imageSize.width, CV_8U );
+            CvMat* disp = cvCreateMat( imageSize.height,
+                imageSize.width, CV_16S );
+            CvMat* vdisp = cvCreateMat( imageSize.height,
+                imageSize.width, CV_8U );
+            CvMat* pair;
+            cvNamedWindow( "rectified", 1 );
 // RECTIFY THE IMAGES AND FIND DISPARITY MAPS
-        if( !isVerticalStereo )
-            pair = cvCreateMat( imageSize.height, imageSize.width*2,
-            CV_8UC3 );
-        else
-            pair = cvCreateMat( imageSize.height*2, imageSize.width,
-            CV_8UC3 );
+            if( !isVerticalStereo )
+                pair = cvCreateMat( imageSize.height, imageSize.width*2,
+                CV_8UC3 );
+            else
+                pair = cvCreateMat( imageSize.height*2, imageSize.width,
+                CV_8UC3 );
 //Setup for finding stereo corrrespondences
-        CvStereoBMState *BMState = cvCreateStereoBMState();
-        assert(BMState != 0);
-        BMState->preFilterSize=41;
-        BMState->preFilterCap=31;
-        BMState->SADWindowSize=41;
-        BMState->minDisparity=-64;
-        BMState->numberOfDisparities=128;
-        BMState->textureThreshold=10;
-        BMState->uniquenessRatio=15;
-        for( i = 0; i < nframes; i++ )
-        {
-            IplImage* img1=cvLoadImage(imageNames[0][i].c_str(),0);
-            IplImage* img2=cvLoadImage(imageNames[1][i].c_str(),0);
-            if( img1 && img2 )
+            CvStereoBMState *BMState = cvCreateStereoBMState();
+            assert(BMState != 0);
+            BMState->preFilterSize=41;
+            BMState->preFilterCap=31;
+            BMState->SADWindowSize=41;
+            BMState->minDisparity=-64;
+            BMState->numberOfDisparities=128;
+            BMState->textureThreshold=10;
+            BMState->uniquenessRatio=15;
+            for( i = 0; i < nframes; i++ )
             {
-                CvMat part;
-                cvRemap( img1, img1r, mx1, my1 );
-                cvRemap( img2, img2r, mx2, my2 );
-                if( !isVerticalStereo || useUncalibrated != 0 )
+                IplImage* img1=cvLoadImage(imageNames[0][i].c_str(),0);
+                IplImage* img2=cvLoadImage(imageNames[1][i].c_str(),0);
+                if( img1 && img2 )
                 {
-              // When the stereo camera is oriented vertically,
-              // useUncalibrated==0 does not transpose the
-              // image, so the epipolar lines in the rectified
-              // images are vertical. Stereo correspondence
-              // function does not support such a case.
-                    cvFindStereoCorrespondenceBM( img1r, img2r, disp,
-                        BMState);
-                    cvNormalize( disp, vdisp, 0, 256, CV_MINMAX );
-                    cvNamedWindow( "disparity" );
-                    cvShowImage( "disparity", vdisp );
+                    CvMat part;
+                    cvRemap( img1, img1r, mx1, my1 );
+                    cvRemap( img2, img2r, mx2, my2 );
+                    if( !isVerticalStereo || useUncalibrated != 0 )
+                    {
+                  // When the stereo camera is oriented vertically,
+                  // useUncalibrated==0 does not transpose the
+                  // image, so the epipolar lines in the rectified
+                  // images are vertical. Stereo correspondence
+                  // function does not support such a case.
+                        cvFindStereoCorrespondenceBM( img1r, img2r, disp,
+                            BMState);
+                        cvNormalize( disp, vdisp, 0, 256, CV_MINMAX );
+                        cvNamedWindow( "disparity" );
+                        cvShowImage( "disparity", vdisp );
+                    }
+                    if( !isVerticalStereo )
+                    {
+                        cvGetCols( pair, &part, 0, imageSize.width );
+                        cvCvtColor( img1r, &part, CV_GRAY2BGR );
+                        cvGetCols( pair, &part, imageSize.width,
+                            imageSize.width*2 );
+                        cvCvtColor( img2r, &part, CV_GRAY2BGR );
+                        for( j = 0; j < imageSize.height; j += 16 )
+                            cvLine( pair, cvPoint(0,j),
+                            cvPoint(imageSize.width*2,j),
+                            CV_RGB(0,255,0));
+                    }
+                    else
+                    {
+                        cvGetRows( pair, &part, 0, imageSize.height );
+                        cvCvtColor( img1r, &part, CV_GRAY2BGR );
+                        cvGetRows( pair, &part, imageSize.height,
+                            imageSize.height*2 );
+                        cvCvtColor( img2r, &part, CV_GRAY2BGR );
+                        for( j = 0; j < imageSize.width; j += 16 )
+                            cvLine( pair, cvPoint(j,0),
+                            cvPoint(j,imageSize.height*2),
+                            CV_RGB(0,255,0));
+                    }
+                    cvShowImage( "rectified", pair );
+                    if( cvWaitKey() == 27 )
+                        break;
                 }
-                if( !isVerticalStereo )
-                {
-                    cvGetCols( pair, &part, 0, imageSize.width );
-                    cvCvtColor( img1r, &part, CV_GRAY2BGR );
-                    cvGetCols( pair, &part, imageSize.width,
-                        imageSize.width*2 );
-                    cvCvtColor( img2r, &part, CV_GRAY2BGR );
-                    for( j = 0; j < imageSize.height; j += 16 )
-                        cvLine( pair, cvPoint(0,j),
-                        cvPoint(imageSize.width*2,j),
-                        CV_RGB(0,255,0));
-                }
-                else
-                {
-                    cvGetRows( pair, &part, 0, imageSize.height );
-                    cvCvtColor( img1r, &part, CV_GRAY2BGR );
-                    cvGetRows( pair, &part, imageSize.height,
-                        imageSize.height*2 );
-                    cvCvtColor( img2r, &part, CV_GRAY2BGR );
-                    for( j = 0; j < imageSize.width; j += 16 )
-                        cvLine( pair, cvPoint(j,0),
-                        cvPoint(j,imageSize.height*2),
-                        CV_RGB(0,255,0));
-                }
-                cvShowImage( "rectified", pair );
-                if( cvWaitKey() == 27 )
-                    break;
+                cvReleaseImage( &img1 );
+                cvReleaseImage( &img2 );
             }
-            cvReleaseImage( &img1 );
-            cvReleaseImage( &img2 );
+            cvReleaseStereoBMState(&BMState);
+            cvReleaseMat( &img1r );
+            cvReleaseMat( &img2r );
+            cvReleaseMat( &disp );
+            cvReleaseMat( &vdisp );
+            cvReleaseMat( &pair );
         }
-        cvReleaseStereoBMState(&BMState);
         cvReleaseMat( &mx1 );
         cvReleaseMat( &my1 );
         cvReleaseMat( &mx2 );
         cvReleaseMat( &my2 );
-        cvReleaseMat( &img1r );
-        cvReleaseMat( &img2r );
-        cvReleaseMat( &disp );
     }
+// MACHINE-READABLE QUALITY REPORT
+    char reportPath[256];
+    strcpy(reportPath, xmlFilesPath);
+    strcat(reportPath, "report.json");
+    WriteReport(reportPath, nx, ny, squareSize, imageSize, rmsErr, avgErr/(nframes*n),
+        fixedPointErr, imageNames, active, viewErr);
 }
 int main(int argc, char *argv[])
 {
@@ -466,10 +615,23 @@ int main(int argc, char *argv[])
     float squareSize;
     char xmlFilesPath[256] = "";
     int fail = 0;
+    int headless = 0;
+    //Options may come anywhere; the rest are positional
+    vector<char*> args;
+    for (int k = 0; k < argc; k++)
+    {
+        if (strcmp(argv[k], "--headless") == 0)
+            headless = 1;
+        else
+            args.push_back(argv[k]);
+    }
+    argc = (int)args.size();
+    argv = &args[0];
     //Check command line
     if (argc < 5 || argc > 6)
     {
-        fprintf(stderr,"USAGE: %s imageList nx ny squareSize\n",argv[0]);
+        fprintf(stderr,"USAGE: %s [--headless] imageList nx ny squareSize\n",argv[0]);
+        fprintf(stderr,"\t --headless (optional): no windows; only write the calibration files and report.json\n");
         fprintf(stderr,"\t imageList : Filename of the image list (string). Example : list.txt\n");
         fprintf(stderr,"\t nx : Number of horizontal squares (int > 0). Example : 9\n");
         fprintf(stderr,"\t ny : Number of vertical squares (int > 0). Example : 6\n");
@@ -503,6 +665,6 @@ int main(int argc, char *argv[])
 
     if(fail != 0) return 1;
 
-    StereoCalib(argv[1], nx, ny, 0, squareSize, xmlFilesPath);
+    StereoCalib(argv[1], nx, ny, 0, squareSize, xmlFilesPath, headless);
     return 0;
 }
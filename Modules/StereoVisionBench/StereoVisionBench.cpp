@@ -0,0 +1,424 @@
+/*
+    Micro-benchmarks of the image processing hot paths on the emulation images, upscaled to the sensor sizes of the
+    camera profiles (Config/Camera/*.pfs). Results are written as JSON, so runs can be diffed across commits.
+    Detection and triangulation are also run on a virtual rig (SyntheticFrameSource) and checked against its ground truth.
+    Run from the build directory, next to the copied Config folder.
+
+    Usage: StereoVisionBench [-i iterations] [-o output.json] [-l label] [-w W] [-h H]
+        -i  timed iterations per benchmark, after one warm-up run (default 10)
+        -o  JSON output file (default: standard output)
+        -l  free label stored in the output, e.g. the commit under test
+        -w  width of chessboard corners of the emulation images (default 9)
+        -h  height of chessboard corners of the emulation images (default 6)
+*/
+
+#include <SV/Utility.hpp>
+#include <SV/ImageProcessing.hpp>
+#include <SV/Rectifier.hpp>
+#include <SV/Preprocessor.hpp>
+#include <SV/Triangulation.hpp>
+#include <SV/CalibrationBundle.hpp>
+#include <SV/SyntheticFrameSource.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <numeric>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unistd.h>
+
+
+namespace
+{
+    // Sensor sizes of default_linux_lowres.pfs, default_linux_midres.pfs and default_linux.pfs
+    const cv::Size SENSOR_SIZES[] = {cv::Size(640, 480), cv::Size(1280, 1024), cv::Size(2590, 1942)};
+
+    const size_t TRIANGULATION_POINTS = 100000u;
+
+    // Virtual rig: chessboard square in centimeters and poses checked against the ground truth
+    const float SYNTHETIC_SQUARE_SIZE = 2.3f;
+    const size_t SYNTHETIC_POSES = 8u;
+
+    struct Result
+    {
+        std::string             name;
+        cv::Size                size;
+        std::vector<double>     milliseconds;
+        // Benchmark specific detail (chessboard found, points triangulated, ...)
+        std::string             note;
+    };
+
+    Result measure(const std::string& name, cv::Size size, int iterations, const std::function<void()>& run)
+    {
+        Result result;
+        result.name = name;
+        result.size = size;
+
+        run();
+        for (int i = 0; i < iterations; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            result.milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        std::sort(result.milliseconds.begin(), result.milliseconds.end());
+        std::cerr << name << " " << size.width << "x" << size.height << ": median " << result.milliseconds[result.milliseconds.size() / 2] << " ms" << std::endl;
+        return result;
+    }
+
+    // BayerGB8 mosaic as the cameras deliver it: G B on even rows, R G on odd rows
+    cv::Mat createBayerGB(const cv::Mat& bgr)
+    {
+        cv::Mat bayer(bgr.size(), CV_8UC1);
+        for (int y = 0; y < bgr.rows; ++y)
+        {
+            auto source = bgr.ptr<cv::Vec3b>(y);
+            auto destination = bayer.ptr<unsigned char>(y);
+            for (int x = 0; x < bgr.cols; ++x)
+            {
+                bool green = (x + y) % 2 == 0;
+                destination[x] = green ? source[x][1] : (y % 2 == 0 ? source[x][0] : source[x][2]);
+            }
+        }
+        return bayer;
+    }
+
+    // Rectification maps of a plausible lens (fx = image width, barrel distortion, small rotation)
+    void createMaps(cv::Size size, cv::Mat& mx, cv::Mat& my)
+    {
+        cv::Mat K = (cv::Mat_<double>(3, 3) << size.width, 0., size.width / 2., 0., size.width, size.height / 2., 0., 0., 1.);
+        cv::Mat D = (cv::Mat_<double>(1, 5) << -0.15, 0.05, 0., 0., 0.);
+        cv::Mat rotation = (cv::Mat_<double>(3, 1) << 0.01, -0.02, 0.005);
+        cv::Mat R;
+        cv::Rodrigues(rotation, R);
+        cv::initUndistortRectifyMap(K, D, R, K, size, CV_32FC1, mx, my);
+    }
+
+    // Q of stereoRectify for that lens and a 10 cm baseline
+    cv::Mat createQ(cv::Size size)
+    {
+        return (cv::Mat_<double>(4, 4) <<
+            1., 0., 0., -size.width / 2.,
+            0., 1., 0., -size.height / 2.,
+            0., 0., 0., (double) size.width,
+            0., 0., 1. / 10., 0.);
+    }
+
+    // Puts detected corners in ground truth order (the detector may start from the opposite corner); returns the RMS error in pixels
+    double alignCorners(std::vector<cv::Point2f>& corners, const std::vector<cv::Point2f>& groundTruth)
+    {
+        double error = 0., reversedError = 0.;
+        for (size_t i = 0; i < corners.size(); ++i)
+        {
+            auto difference = corners[i] - groundTruth[i];
+            auto reversedDifference = corners[corners.size() - 1u - i] - groundTruth[i];
+            error += difference.dot(difference);
+            reversedError += reversedDifference.dot(reversedDifference);
+        }
+        if (reversedError < error)
+        {
+            std::reverse(corners.begin(), corners.end());
+            error = reversedError;
+        }
+        return std::sqrt(error / corners.size());
+    }
+
+    std::string createTemporaryDirectory()
+    {
+        char path[] = "/tmp/StereoVisionBench.XXXXXX";
+        if (mkdtemp(path) == nullptr)
+            throw std::runtime_error("createTemporaryDirectory() - Failed to create a temporary directory");
+        return std::string(path) + "/";
+    }
+
+    void writeJSON(std::ostream& stream, const std::string& label, int iterations, const std::vector<Result>& results)
+    {
+        auto timestamp = SV::getTimestamp();
+        timestamp.erase(std::remove(timestamp.begin(), timestamp.end(), '\n'), timestamp.end());
+
+        stream << "{\n";
+        stream << "  \"label\": \"" << label << "\",\n";
+        stream << "  \"timestamp\": \"" << timestamp << "\",\n";
+        stream << "  \"iterations\": " << iterations << ",\n";
+        stream << "  \"threads\": " << cv::getNumThreads() << ",\n";
+        stream << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            auto& result = results[i];
+            auto& ms = result.milliseconds;
+            auto mean = std::accumulate(ms.begin(), ms.end(), 0.) / ms.size();
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                "    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"min_ms\": %.4f, \"median_ms\": %.4f, \"mean_ms\": %.4f, \"max_ms\": %.4f, \"note\": \"%s\"}%s\n",
+                result.name.c_str(), result.size.width, result.size.height, ms.front(), ms[ms.size() / 2], mean, ms.back(),
+                result.note.c_str(), i + 1 < results.size() ? "," : "");
+            stream << line;
+        }
+        stream << "  ]\n";
+        stream << "}\n";
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    int option, iterations = 10;
+    unsigned int w = 9, h = 6;
+    std::string outputFile, label;
+
+    opterr = 0;
+    while ((option = getopt(argc, argv, "i:o:l:w:h:")) != -1)
+    {
+        switch (option)
+        {
+            case 'i':
+                iterations = std::max(1, std::atoi(optarg));
+                break;
+            case 'o':
+                outputFile = optarg;
+                break;
+            case 'l':
+                label = optarg;
+                break;
+            case 'w':
+                w = std::atoi(optarg);
+                break;
+            case 'h':
+                h = std::atoi(optarg);
+                break;
+            default:
+                std::cerr << "Usage: StereoVisionBench [-i iterations] [-o output.json] [-l label] [-w W] [-h H]" << std::endl;
+                return 1;
+        }
+    }
+
+    try
+    {
+        auto emulatedImage = cv::imread(SV::EMULATED_IMAGES_PATH + "04left.ppm");
+        if (emulatedImage.empty())
+            throw std::runtime_error("main() - Emulation images not found in " + SV::EMULATED_IMAGES_PATH + "; run from the build directory");
+
+        cv::Size patternSize(w, h);
+        auto temporaryPath = createTemporaryDirectory();
+        std::vector<Result> results;
+        for (auto size : SENSOR_SIZES)
+        {
+            cv::Mat bgr, bayer, gray, binary, rectified;
+            cv::resize(emulatedImage, bgr, size, 0., 0., cv::INTER_LINEAR);
+            bayer = createBayerGB(bgr);
+
+            // Preprocessing stage
+            results.push_back(measure("gray_bgr8", size, iterations, [&]() { SV::convertToGray(bgr, SV::PIXEL_FORMAT_BGR8, gray, false); }));
+            results.push_back(measure("gray_bayergb8", size, iterations, [&]() { SV::convertToGray(bayer, SV::PIXEL_FORMAT_BAYERGB8, gray, false); }));
+            results.push_back(measure("gray_bayergb8_binned", size, iterations, [&]() { SV::convertToGray(bayer, SV::PIXEL_FORMAT_BAYERGB8, gray, true); }));
+            SV::convertToGray(bayer, SV::PIXEL_FORMAT_BAYERGB8, gray, false);
+            results.push_back(measure("otsu_threshold", size, iterations, [&]() { cv::threshold(gray, binary, 0., 255., CV_THRESH_BINARY + CV_THRESH_OTSU); }));
+
+            // Remap with every map format of the calibration bundle
+            cv::Mat mx, my;
+            createMaps(size, mx, my);
+            std::vector<CalibrationBundle::NamedMatrix> matrices
+            {
+                CalibrationBundle::NamedMatrix("Q", createQ(size)),
+                CalibrationBundle::NamedMatrix("mx1", mx),
+                CalibrationBundle::NamedMatrix("my1", my),
+                CalibrationBundle::NamedMatrix("mx2", mx),
+                CalibrationBundle::NamedMatrix("my2", my)
+            };
+            auto fixedPointMaps = Rectifier::createFixedPointMaps(mx, my, "1");
+            matrices.insert(matrices.end(), fixedPointMaps.begin(), fixedPointMaps.end());
+            auto calibrationBundle = CalibrationBundle::createFromMatrices(matrices);
+
+            struct RemapVariant { const char* name; SV::RemapMode mode; int interpolation; };
+            RemapVariant remapVariants[] =
+            {
+                {"remap_float_linear", SV::REMAP_FLOAT_MAPS, cv::INTER_LINEAR},
+                {"remap_fixed_point_linear", SV::REMAP_FIXED_POINT_MAPS, cv::INTER_LINEAR},
+                {"remap_float_nearest", SV::REMAP_FLOAT_MAPS, cv::INTER_NEAREST},
+                {"remap_fixed_point_nearest", SV::REMAP_FIXED_POINT_MAPS, cv::INTER_NEAREST}
+            };
+            for (auto& variant : remapVariants)
+            {
+                Rectifier rectifier(calibrationBundle, 0, variant.mode, variant.interpolation);
+                results.push_back(measure(variant.name, size, iterations, [&]() { rectifier.rectify(binary, rectified); }));
+            }
+
+            // Whole preprocessing stage of one Bayer frame: one image at a time, then fused in bands on one and on every core
+            {
+                Rectifier rectifier(calibrationBundle, 0, SV::REMAP_MODE, SV::REMAP_INTERPOLATION);
+                results.push_back(measure("preprocess_sequential", size, iterations, [&]()
+                {
+                    SV::convertToGray(bayer, SV::PIXEL_FORMAT_BAYERGB8, gray, false);
+                    cv::threshold(gray, binary, 0., 255., CV_THRESH_BINARY + CV_THRESH_OTSU);
+                    rectifier.rectify(binary, rectified);
+                }));
+                for (auto bandSize : {(size_t) 0u, SV::PREPROCESSING_BAND_SIZE})
+                {
+                    Preprocessor preprocessor(&rectifier, bandSize);
+                    results.push_back(measure(bandSize == 0u ? "preprocess_one_band" : "preprocess_banded", size, iterations, [&]()
+                    {
+                        preprocessor.convert(bayer, SV::PIXEL_FORMAT_BAYERGB8, false, gray);
+                        preprocessor.rectify(gray, preprocessor.threshold(), binary, rectified);
+                    }));
+                }
+            }
+
+            // Chessboard detection on the binarized image, as the detection stage sees it
+            std::vector<cv::Point2f> corners;
+            for (auto levels : {0, SV::CHESSBOARD_PYRAMID_LEVELS})
+            {
+                bool found = false;
+                auto result = measure(levels == 0 ? "chessboard_full" : "chessboard_coarse_to_fine", size, iterations,
+                    [&]() { found = SV::findChessboardCornersCoarseToFine(binary, patternSize, corners, levels); });
+                result.note = std::string("found: ") + (found ? "true" : "false") + ", levels: " + std::to_string(levels);
+                results.push_back(result);
+            }
+
+            // Triangulation of one chessboard and of a dense point set
+            cv::RNG rng(size.area());
+            for (auto count : {(size_t) patternSize.area(), TRIANGULATION_POINTS})
+            {
+                SV::Points2D left, right;
+                SV::Points3D points;
+                left.resize(count);
+                right.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    left.x[i] = rng.uniform(0.f, (float) size.width);
+                    left.y[i] = rng.uniform(0.f, (float) size.height);
+                    right.x[i] = left.x[i] - rng.uniform(1.f, 128.f);
+                    right.y[i] = left.y[i];
+                }
+                auto Q = calibrationBundle->getMatrix("Q");
+                auto result = measure("triangulation", size, iterations, [&]() { SV::triangulate(Q, left, right, points); });
+                result.note = "points: " + std::to_string(count);
+                results.push_back(result);
+            }
+
+            // Detection and triangulation of a Bayer pair of the virtual rig, as the pipeline runs them; accuracy over every pose
+            SyntheticFrameSource::Parameters parameters(size, patternSize, SYNTHETIC_SQUARE_SIZE);
+            parameters.pixelFormat = SV::PIXEL_FORMAT_BAYERGB8;
+            parameters.poses = SYNTHETIC_POSES;
+            SyntheticFrameSource syntheticFrameSource(parameters);
+            syntheticFrameSource.open();
+            syntheticFrameSource.startGrabbing();
+            auto syntheticQ = syntheticFrameSource.getCalibrationBundle(0u, 1u)->getMatrix("Q");
+            size_t found = 0u;
+            double cornerError = 0., pointError = 0.;
+            for (size_t pose = 0; pose < SYNTHETIC_POSES; ++pose)
+            {
+                SV::Frame frames[2];
+                std::vector<cv::Point2f> poseCorners[2];
+                auto& groundTruth = syntheticFrameSource.getGroundTruth(pose);
+                auto run = [&]()
+                {
+                    for (int camera = 0; camera < 2; ++camera)
+                    {
+                        SV::convertToGray(frames[camera].image, frames[camera].pixelFormat, gray, false);
+                        cv::threshold(gray, binary, 0., 255., CV_THRESH_BINARY + CV_THRESH_OTSU);
+                        if (!SV::findChessboardCornersCoarseToFine(binary, patternSize, poseCorners[camera], SV::CHESSBOARD_PYRAMID_LEVELS))
+                            poseCorners[camera].clear();
+                    }
+                };
+
+                syntheticFrameSource.retrieveFrame(frames[0], 0u);
+                syntheticFrameSource.retrieveFrame(frames[1], 0u);
+                if (pose == 0u)
+                    results.push_back(measure("synthetic_bayer_pair_detection", size, iterations, run));
+                else
+                    run();
+                if (poseCorners[0].size() != groundTruth.corners.size() || poseCorners[1].size() != groundTruth.corners.size())
+                    continue;
+
+                ++found;
+                cornerError += alignCorners(poseCorners[0], groundTruth.cornersLeft) + alignCorners(poseCorners[1], groundTruth.cornersRight);
+                SV::Points2D left, right;
+                SV::Points3D points;
+                SV::toPoints2D(poseCorners[0], left);
+                SV::toPoints2D(poseCorners[1], right);
+                SV::triangulate(syntheticQ, left, right, points);
+                auto posePointError = 0.;
+                for (size_t i = 0; i < points.size(); ++i)
+                {
+                    // Signed, in left camera coordinates, relative to the depth of the corner
+                    auto& corner = groundTruth.corners[i];
+                    auto dx = points.x[i] - corner.x, dy = points.y[i] - corner.y, dz = points.z[i] - corner.z;
+                    posePointError += (dx * dx + dy * dy + dz * dz) / (corner.z * corner.z);
+                }
+                pointError += std::sqrt(posePointError / points.size());
+            }
+            char accuracy[128];
+            std::snprintf(accuracy, sizeof(accuracy), "found: %zu/%zu, corner rms: %.3f px, point rms: %.3f%%", found, SYNTHETIC_POSES,
+                found > 0u ? cornerError / (2u * found) : 0., found > 0u ? 100. * pointError / found : 0.);
+            results.back().note = accuracy;
+            std::cerr << "synthetic accuracy " << size.width << "x" << size.height << ": " << accuracy << std::endl;
+
+            // Calibration load: XML files versus the memory-mapped binary bundle (the latter also touching every map page)
+            std::vector<std::string> names;
+            for (auto& matrix : matrices)
+            {
+                cv::FileStorage fs(temporaryPath + matrix.first + ".xml", cv::FileStorage::WRITE);
+                fs << matrix.first << matrix.second;
+                names.push_back(matrix.first);
+            }
+            auto bundleFile = temporaryPath + CalibrationBundle::FILE_NAME;
+            CalibrationBundle::saveBinaryFile(bundleFile, matrices);
+
+            results.push_back(measure("calibration_load_xml", size, iterations, [&]()
+            {
+                if (!CalibrationBundle::loadXMLFiles(temporaryPath, names))
+                    throw std::runtime_error("main() - Failed to load the XML calibration");
+            }));
+            results.push_back(measure("calibration_load_binary", size, iterations, [&]()
+            {
+                if (!CalibrationBundle::loadBinaryFile(bundleFile))
+                    throw std::runtime_error("main() - Failed to load the binary calibration");
+            }));
+            results.push_back(measure("calibration_load_binary_touched", size, iterations, [&]()
+            {
+                auto bundle = CalibrationBundle::loadBinaryFile(bundleFile);
+                volatile unsigned char sink = 0;
+                for (auto& matrix : bundle->getMatrices())
+                    for (int row = 0; row < matrix.second.rows; row += std::max(1, 4096 / (int) matrix.second.step[0]))
+                        sink ^= *matrix.second.ptr(row);
+            }));
+
+            for (auto& name : names)
+                std::remove((temporaryPath + name + ".xml").c_str());
+            std::remove(bundleFile.c_str());
+        }
+        rmdir(temporaryPath.c_str());
+
+        if (outputFile.empty())
+        {
+            writeJSON(std::cout, label, iterations, results);
+        }
+        else
+        {
+            std::ofstream output(outputFile);
+            if (!output.is_open())
+                throw std::runtime_error("main() - Failed to write " + outputFile);
+            writeJSON(output, label, iterations, results);
+            std::cerr << "Results written to " << outputFile << std::endl;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
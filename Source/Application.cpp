@@ -1,87 +1,146 @@
 #include <SV/Application.hpp>
 #include <SV/CameraCalibration.hpp>
 #include <SV/CameraCapture.hpp>
-#include <SV/CameraConfiguration.hpp>
+#include <SV/StereoPipeline.hpp>
+#include <SV/StereoRig.hpp>
+#include <SV/StereoSynchronizer.hpp>
+#include <SV/StereoCalibrator.hpp>
+#include <SV/ImageWriter.hpp>
+#include <SV/FrameRecorder.hpp>
+#include <SV/BandwidthScheduler.hpp>
 
 #include <opencv2/highgui/highgui.hpp>
 
+#include <chrono>
 #include <memory>
+#include <thread>
+#include <vector>
 #include <utility>
+#include <algorithm>
+#include <cmath>
 #include <cassert>
+#include <csignal>
 #include <iostream>
 #include <stdexcept>
 
-Application::Application(CalibrationParameters calibrationParameters)
-: mAutoInitTerm()
-, mTransportLayerFactory(Pylon::CTlFactory::GetInstance())
-, mDevices()
-, mCameras(SV::MAX_NUMBER_OF_CAMERAS)
+namespace
+{
+    // Headless capture and recording have no window to press ESC on; Ctrl+C stops them instead
+    volatile std::sig_atomic_t interrupted = 0;
+
+    void onInterrupt(int)
+    {
+        interrupted = 1;
+    }
+}
+
+
+Application::Application(CalibrationParameters calibrationParameters, std::unique_ptr<FrameSource> frameSource, bool headless, std::string recordingFile)
+: mFrameSource(std::move(frameSource))
+, mFrameHandlers()
 , mCameraNames()
+, mRig()
 , mCalibrationParameters(calibrationParameters)
+, mHeadless(headless)
+, mRecordingFile(recordingFile)
+, mCalibrationBundle()
 {
+    openFrameSource();
     scheduleCalibration();
-    attachDevices();    
-    // Triggers Configuration Event (CameraConfiguration.cpp)
-    mCameras.Open();
 }
 
 void Application::run()
 {       
-    if (mCameras.IsOpen())            
+    if (mFrameSource->isOpen() && !mRecordingFile.empty())
+        record();
+    else if (mFrameSource->isOpen())            
         mCalibrationParameters.calibrated ? capture() : calibrate();
     else     
         throw std::runtime_error("Application::run() - Failed to Open Cameras");    
-    mCameras.Close();
+    mFrameSource->close();
 }
 
 void Application::calibrate()
 {
-    Pylon::CGrabResultPtr grabResultPtr;
     SV::saveCalibrationPatternFile(mCalibrationParameters.width, mCalibrationParameters.height, mCalibrationParameters.size);    
+    auto& rigPair = mRig[mCalibrationParameters.pair];
 
     // Setup Variables and Pointers shared between Cameras    
     float d = mCalibrationParameters.delay * 1000.f;
-    std::unique_ptr<bool> synchronizedPtr(new bool);
-    auto synchronized = synchronizedPtr.get();
-    *synchronized = false;
-    std::unique_ptr<unsigned int> grabCountPtr(new unsigned int);
+    // Calibration views are paired like capture frames; only pairs where both cameras saw the chessboard count
+    std::unique_ptr<StereoSynchronizer> stereoSynchronizerPtr(new StereoSynchronizer(SV::SYNCHRONIZATION_MODE, SV::SYNCHRONIZATION_MAXIMUM_SKEW, SV::SYNCHRONIZATION_DEPTH));
+    std::unique_ptr<std::atomic<unsigned int>> grabCountPtr(new std::atomic<unsigned int>(0u));
     auto grabCount = grabCountPtr.get();
-    *grabCount = 0u;
     auto currentGrabCount = 0u;    
     std::unique_ptr<std::ofstream> imageListFilePtr(new std::ofstream(SV::CALIBRATION_IMAGES_FILE, std::ofstream::out));
     auto imageListFile = imageListFilePtr.get();
-    std::unique_ptr<std::pair<bool, bool>> wroteToFilePairPtr(new std::pair<bool, bool>);
-    auto wroteToFilePair = wroteToFilePairPtr.get();
-    wroteToFilePair->first = false;
-    wroteToFilePair->second = false;
+
+    std::unique_ptr<StereoCalibrator> stereoCalibratorPtr(new StereoCalibrator(cv::Size(mCalibrationParameters.width, mCalibrationParameters.height), mCalibrationParameters.size));
+    auto stereoCalibrator = stereoCalibratorPtr.get();
+    // Calibration photos are written off the grab path
+    std::unique_ptr<ImageWriter> imageWriterPtr(new ImageWriter(SV::IMAGE_WRITER_QUEUE_CAPACITY, SV::IMAGE_WRITER_PNG_COMPRESSION));
+    auto imageWriter = imageWriterPtr.get();
 
     std::cout << "Prepare to Capture Images for Calibration!" << std::endl;
-    registerCameraCalibration(synchronized, grabCount, imageListFile, wroteToFilePair);    
+    registerCameraCalibration(rigPair, stereoSynchronizerPtr.get(), stereoCalibrator, grabCount, imageWriter, imageListFile);    
     
-    // Cameras Synchronization: Round-Robin Strategy
-    mCameras.StartGrabbing(Pylon::GrabStrategy_UpcomingImage);       
-    while (mCameras.IsGrabbing() && *grabCount < mCalibrationParameters.numberPhotos)
+    mFrameSource->startGrabbing();       
+    while (mFrameSource->isGrabbing() && *grabCount < mCalibrationParameters.numberPhotos)
     {            
         // Triggers Calibration Event
-        mCameras.RetrieveResult(Pylon::INFINITE, grabResultPtr, Pylon::TimeoutHandling_ThrowException);
+        dispatchFrame(5000);
 
         if (*grabCount > currentGrabCount)
         {
             currentGrabCount = *grabCount;
-            cv::waitKey(d);
+            waitKey(d);
         }
         else
-            cv::waitKey(30);
+            waitKey(30);
     }
-    mCameras.StopGrabbing();
     imageListFile->close();
+    // Every photo is on disk before the solver starts
+    imageWriter->flush();
     std::cout << "Stereo Photos Captured: " << *grabCount << "/" << mCalibrationParameters.numberPhotos << std::endl;        
+    if (imageWriter->getFailedWrites() > 0u)
+        std::cout << "Failed to write " << imageWriter->getFailedWrites() << " photos." << std::endl;
 
-    // Start Stereo Calibration Module
+    // Calibrate on a worker thread from the corners already in memory; the cameras keep grabbing meanwhile
     auto startTime = cv::getTickCount();
-    SV::forkExecStereoCalibrationModule(mCalibrationParameters.width, mCalibrationParameters.height, mCalibrationParameters.size);
+    stereoCalibrator->start(rigPair.calibrationPath);
+    auto step = StereoCalibrator::STEP_DONE;
+    while (!stereoCalibrator->isFinished())
+    {
+        if (stereoCalibrator->getStep() != step)
+        {
+            step = stereoCalibrator->getStep();
+            std::cout << StereoCalibrator::getStepName(step) << "... (" << (int) (stereoCalibrator->getProgress() * 100.f) << "%)" << std::endl;
+        }
+
+        if (mFrameSource->isGrabbing())
+            dispatchFrame(30);
+        // ESC cancels at the next calibration step
+        if ((waitKey(1) & 255) == 27)
+            stereoCalibrator->cancel();
+    }
+    stereoCalibrator->wait();
+    mFrameSource->stopGrabbing();
     auto finishTime = (cv::getTickCount() - startTime) / cv::getTickFrequency();
 
+    if (stereoCalibrator->getState() == StereoCalibrator::STATE_CANCELLED)
+    {
+        std::cout << "Stereo Calibration cancelled." << std::endl;
+        return;
+    }
+    if (stereoCalibrator->getState() != StereoCalibrator::STATE_SUCCEEDED)
+        throw std::runtime_error("Application::calibrate() - Stereo calibration failed");
+
+    auto report = stereoCalibrator->getReport();
+    std::cout << "Calibrated " << report.views << " views: RMS error " << report.reprojectionError << ", epipolar error " << report.epipolarError
+        << ", fixed-point map error " << report.fixedPointError << std::endl;
+
+    // Capture starts straight from the calibration in memory
+    mCalibrationBundle = stereoCalibrator->getCalibrationBundle();
     SV::saveCalibrationTimestampFile();    
     mCalibrationParameters.calibrated = true;
     std::cout << "Stereo Calibration completed in " << finishTime << " seconds at " << SV::loadCalibrationTimestampFile() << std::endl;
@@ -92,43 +151,166 @@ void Application::calibrate()
 void Application::capture()
 {
     std::cout << SV::lineBreak << "Initializing Capture. Press ESC while focused on any window to exit." << std::endl;
-    std::unique_ptr<SV::StereoPhoto> stereoPhotoPtr(new SV::StereoPhoto);
-    auto stereoPhoto = stereoPhotoPtr.get();
-    
-    registerCameraCapture(stereoPhoto);    
-    Pylon::CGrabResultPtr grabResultPtr;    
-    
-    // Cameras Synchronization: Round-Robin Strategy
-    mCameras.StartGrabbing(Pylon::GrabStrategy_UpcomingImage);       
-    while(mCameras.IsGrabbing())
+
+    auto calibrationPattern = SV::loadCalibrationPatternFile();
+    auto detectWorkers = SV::PIPELINE_DETECT_WORKERS;
+    if (detectWorkers == 0u)
     {
-        auto startTime = cv::getTickCount();
-        // Triggers Capture Event
-        mCameras.RetrieveResult(5000, grabResultPtr, Pylon::TimeoutHandling_ThrowException);
-    
-        // Keyboard input break with ESC key
-        int key = cv::waitKey(30);
-        if((key & 255) == 27)
+        // The grab thread, plus pair, match and triangulate threads and one preprocessing thread per camera of every pair
+        auto busyThreads = 1u + (unsigned int) mRig.size() * ((SV::DENSE_DISPARITY ? 3u : 2u) + 2u);
+        auto hardwareThreads = std::thread::hardware_concurrency();
+        detectWorkers = hardwareThreads > busyThreads ? std::max((hardwareThreads - busyThreads) / (unsigned int) mRig.size(), 1u) : 1u;
+    }
+
+    // One pipeline, with its own workers, per pair
+    std::vector<std::unique_ptr<SharedFrameWriter>> sharedFrameWriters;
+    std::vector<std::unique_ptr<StereoPipeline>> stereoPipelines;
+    StereoRig stereoRig;
+    mFrameHandlers.clear();
+    for (size_t i = 0; i < mRig.size(); ++i)
+    {
+        auto& rigPair = mRig[i];
+        // Loaded once and shared by both cameras, unless calibrate() just produced it or the frame source knows it
+        std::shared_ptr<const CalibrationBundle> calibrationBundle;
+        if (i == mCalibrationParameters.pair)
+            calibrationBundle = mCalibrationBundle;
+        if (!calibrationBundle)
+        {
+            calibrationBundle = mFrameSource->getCalibrationBundle(rigPair.left, rigPair.right);
+            if (calibrationBundle)
+                std::cout << "Calibration given by the frame source" << std::endl;
+        }
+        if (!calibrationBundle)
         {
-            /*
-            The time spent in each iteration of the main loop must be added in the FTD of each camera.
-            Doing this results in less FPS, but avoid delays when displaying the captured image.
-            This is the main trade-off: the more processing, the less frame per seconds.
-            Check Utility files for more information.
-            */
-            auto finishTime = (cv::getTickCount() - startTime) / cv::getTickFrequency();
-            std::cout << "Spent " << finishTime << " seconds in the last iteration." << std::endl;
+            calibrationBundle = SV::loadCalibrationBundle(rigPair.calibrationPath);
+            std::cout << "Calibration loaded from " << (calibrationBundle->isMemoryMapped() ? "binary bundle" : "XML files") << " in " << rigPair.calibrationPath << std::endl;
+        }
+
+        SharedFrameWriter* sharedFrameWriterPtr = nullptr;
+        if (SV::SHARED_FRAME_RING)
+        {
+            // The first pair keeps the plain ring name
+            auto ringName = i == 0u ? SV::SHARED_FRAME_RING_NAME : SV::SHARED_FRAME_RING_NAME + "_" + std::to_string(i);
+            sharedFrameWriters.push_back(std::unique_ptr<SharedFrameWriter>(new SharedFrameWriter(ringName, SV::SHARED_FRAME_RING_SLOTS, calibrationBundle->getChecksum())));
+            sharedFrameWriterPtr = sharedFrameWriters.back().get();
+        }
+
+        std::vector<std::string> cameraNames{mCameraNames[rigPair.left], mCameraNames[rigPair.right]};
+        stereoPipelines.push_back(std::unique_ptr<StereoPipeline>(new StereoPipeline(rigPair.name, cameraNames, cv::Size(calibrationPattern.w, calibrationPattern.h),
+            calibrationBundle->getMatrix("Q"), detectWorkers, sharedFrameWriterPtr, mHeadless)));
+        registerCameraCapture(rigPair, stereoPipelines.back().get(), calibrationBundle);
+        stereoRig.addPair(stereoPipelines.back().get(), rigPair.left, rigPair.right);
+    }
+
+    if (mHeadless)
+    {
+        interrupted = 0;
+        std::signal(SIGINT, onInterrupt);
+        std::cout << "Headless: press Ctrl+C to exit." << std::endl;
+    }
+
+    mFrameSource->startGrabbing();
+    for (size_t i = 0; i < stereoPipelines.size(); ++i)
+        stereoPipelines[i]->start({mFrameHandlers[2 * i].get(), mFrameHandlers[2 * i + 1].get()});
+    stereoRig.start(mFrameSource.get());
+    auto lastDump = std::chrono::steady_clock::now();
+    auto refreshPeriod = std::chrono::milliseconds(1000u / std::max(SV::DISPLAY_REFRESH_RATE, 1u));
+    auto scheduledPeriod = 0.;
+    while (stereoRig.isRunning())
+    {
+        if (SV::INSTRUMENTATION_DUMP_INTERVAL > 0u && std::chrono::steady_clock::now() - lastDump >= std::chrono::seconds(SV::INSTRUMENTATION_DUMP_INTERVAL))
+        {
+            auto processingPeriod = 0.;
+            for (auto& stereoPipeline : stereoPipelines)
+            {
+                if (!stereoPipeline->getName().empty())
+                    std::cout << "Pipeline " << stereoPipeline->getName() << ":" << std::endl;
+                stereoPipeline->getInstrumentation()->dump(std::cout);
+                processingPeriod = std::max(processingPeriod, stereoPipeline->getProcessingPeriod());
+            }
+            lastDump = std::chrono::steady_clock::now();
+
+            // Cameras send no faster than the slowest pair consumes: re-tune the delays when its pace changes
+            if (SV::BANDWIDTH_SCHEDULING && std::abs(processingPeriod - scheduledPeriod) > SV::GIGE_RESCHEDULE_THRESHOLD * scheduledPeriod)
+            {
+                scheduleTransportDelays(processingPeriod);
+                scheduledPeriod = processingPeriod;
+            }
+        }
+
+        if (mHeadless)
+        {
+            if (interrupted)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        // Present stage: draws the newest stereo frame of every pair on this thread, at most once per refresh
+        auto refreshStart = std::chrono::steady_clock::now();
+        for (auto& stereoPipeline : stereoPipelines)
+            stereoPipeline->present(0u);
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(refreshStart + refreshPeriod - std::chrono::steady_clock::now());
+
+        // Keyboard input break with ESC key; also waits out the rest of the refresh period
+        int key = waitKey(std::max((int) remaining.count(), 1));
+        if((key & 255) == 27)
             break;        
+    }
+    stereoRig.stop();
+    for (auto& stereoPipeline : stereoPipelines)
+        stereoPipeline->stop();
+    mFrameSource->stopGrabbing();
+    mFrameHandlers.clear();
+    if (mHeadless)
+        std::signal(SIGINT, SIG_DFL);
+}
+
+void Application::record()
+{
+    std::cout << SV::lineBreak << "Recording " << mFrameSource->getNumberOfCameras() << " cameras to " << mRecordingFile << ". Press Ctrl+C to stop." << std::endl;
+    FrameRecorder frameRecorder(mRecordingFile, mFrameSource->getNumberOfCameras(), SV::RECORDING_CHUNK_SIZE, SV::RECORDING_CHUNKS);
+    interrupted = 0;
+    std::signal(SIGINT, onInterrupt);
+
+    mFrameSource->startGrabbing();
+    auto lastReport = std::chrono::steady_clock::now();
+    auto lastFrames = frameRecorder.getRecordedFrames();
+    auto lastBytes = frameRecorder.getRecordedBytes();
+    while (mFrameSource->isGrabbing() && !interrupted)
+    {
+        SV::Frame frame;
+        if (mFrameSource->retrieveFrame(frame, 100u))
+            frameRecorder.record(frame);
+
+        auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - lastReport).count();
+        if (SV::INSTRUMENTATION_DUMP_INTERVAL > 0u && elapsed >= SV::INSTRUMENTATION_DUMP_INTERVAL)
+        {
+            std::cout << "Recorded " << frameRecorder.getRecordedFrames() << " frames: " << (frameRecorder.getRecordedFrames() - lastFrames) / elapsed << " frames/s, "
+                      << (frameRecorder.getRecordedBytes() - lastBytes) / elapsed / (1024. * 1024.) << " MiB/s, waited " << frameRecorder.getWaitTime() << " s for the disk" << std::endl;
+            lastReport = std::chrono::steady_clock::now();
+            lastFrames = frameRecorder.getRecordedFrames();
+            lastBytes = frameRecorder.getRecordedBytes();
         }
     }
-    mCameras.StopGrabbing();
+    mFrameSource->stopGrabbing();
+    std::signal(SIGINT, SIG_DFL);
+    frameRecorder.close();
 }
 
 void Application::scheduleCalibration()
 {
     std::string timestamp = SV::loadCalibrationTimestampFile();
 
-    if (timestamp == SV::NOT_CALIBRATED || timestamp == "")
+    // A virtual rig knows its calibration: capture runs without one, unless a calibration was asked for
+    auto calibrationKnown = std::all_of(mRig.begin(), mRig.end(),
+        [this](const SV::RigPair& rigPair) { return mFrameSource->getCalibrationBundle(rigPair.left, rigPair.right) != nullptr; });
+
+    if ((timestamp == SV::NOT_CALIBRATED || timestamp == "") && mCalibrationParameters.calibrated && calibrationKnown)
+    {
+        std::cout << "Cameras have never been calibrated. Using the calibration of the frame source." << std::endl;
+    }
+    else if (timestamp == SV::NOT_CALIBRATED || timestamp == "")
     {
         std::cout << "Cameras have never been calibrated. Scheduling calibration..." << std::endl;
         mCalibrationParameters.calibrated = false;
@@ -143,62 +325,94 @@ void Application::scheduleCalibration()
     }
 }
 
-void Application::attachDevices()
+void Application::openFrameSource()
 {
-    if (mTransportLayerFactory.EnumerateDevices(mDevices) == 0)
-        throw std::runtime_error("Application::Application() - No Camera Devices found");    
-
-    for (size_t i = 0; i < mDevices.size(); ++i)
-    {
-        std::string cameraName, cameraModel;
-        // Attach device to Pylon's camera array
-        mCameras[i].Attach(mTransportLayerFactory.CreateDevice(mDevices[i]));
-        Pylon::CInstantCamera &camera = mCameras[i];
-        // Define Camera Name for logging and OpenCV NamedWindow
-        i % 2 == 0 ? cameraName = "Left Camera" : cameraName = "Right Camera";
-        cameraModel += camera.GetDeviceInfo().GetModelName();        
-        mCameraNames.push_back(cameraName);
-        // Register Camera's Configuration
-        if (cameraModel != SV::EMULATED_CAMERA)
-        {            
-            camera.RegisterConfiguration
-            (
-                new CameraConfiguration(SV::CONFIGURATION_FILE, SV::INTER_PACKET_DELAY, SV::FRAME_TRANSMISSION_DELAY * (int) (i + 1), cameraName), 
-                Pylon::RegistrationMode_ReplaceAll, 
-                Pylon::Cleanup_Delete
-            );           
-        }
-        else
-        {
-            SV::EMULATION_MODE = true;
-            mCalibrationParameters.size = 2.5f; // square size in emulation images
-        }
-    }    
+    mFrameSource->open();
+
+    // Cameras of a stereo pair are named after it, any other keeps the frame source's name
+    mRig = SV::loadRig(mFrameSource->getNumberOfCameras());
+    if (mCalibrationParameters.pair >= mRig.size())
+        throw std::runtime_error("Application::openFrameSource() - No rig pair " + std::to_string(mCalibrationParameters.pair) + " to calibrate");
+    for (size_t i = 0; i < mFrameSource->getNumberOfCameras(); ++i)
+        mCameraNames.push_back(mFrameSource->getCameraName(i));
+    for (auto& rigPair : mRig)
+    {
+        mCameraNames[rigPair.left] = SV::getCameraName(rigPair, rigPair.left);
+        mCameraNames[rigPair.right] = SV::getCameraName(rigPair, rigPair.right);
+    }
+
+    if (mFrameSource->isEmulated())
+    {
+        SV::EMULATION_MODE = true;
+        mCalibrationParameters.size = 2.5f; // square size in emulation images
+    }
+}
+
+void Application::scheduleTransportDelays(double processingPeriod)
+{
+    std::vector<SV::StreamParameters> streams;
+    for (size_t i = 0; i < mFrameSource->getNumberOfCameras(); ++i)
+    {
+        SV::StreamParameters streamParameters;
+        if (!mFrameSource->getStreamParameters(i, streamParameters))
+            return;
+        streams.push_back(streamParameters);
+    }
+
+    BandwidthScheduler bandwidthScheduler(SV::GIGE_LINK_BANDWIDTH, SV::GIGE_SCHEDULE_MARGIN);
+    auto schedule = bandwidthScheduler.compute(streams, processingPeriod);
+    std::cout << "Processing period " << processingPeriod * 1000. << " ms; rescheduling transport delays for " << 1. / schedule.framePeriod << " FPS per camera"
+              << " (link allows " << 1. / schedule.linkPeriod << ")" << std::endl;
+    for (size_t i = 0; i < schedule.delays.size(); ++i)
+        mFrameSource->setTransportDelays(i, schedule.delays[i]);
+}
+
+int Application::waitKey(int delay)
+{
+    if (!mHeadless)
+        return cv::waitKey(delay);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+    return -1;
+}
+
+bool Application::dispatchFrame(unsigned int timeout)
+{
+    SV::Frame frame;
+    if (!mFrameSource->retrieveFrame(frame, timeout))
+        return false;
+
+    // Only the pair under calibration; its handlers see the cameras as 0 (left) and 1 (right)
+    auto& rigPair = mRig[mCalibrationParameters.pair];
+    if (frame.camera != rigPair.left && frame.camera != rigPair.right)
+        return true;
+    frame.camera = frame.camera == rigPair.left ? 0u : 1u;
+    mFrameHandlers[frame.camera]->onFrameGrabbed(frame);
+
+    return true;
 }
 
-void Application::registerCameraCalibration(bool* synchronizedPtr, unsigned int* grabCountPtr, std::ofstream* imageListFilePtr, std::pair<bool, bool>* wroteToFilePairPtr)
+void Application::registerCameraCalibration(const SV::RigPair& rigPair, StereoSynchronizer* stereoSynchronizerPtr, StereoCalibrator* stereoCalibratorPtr, std::atomic<unsigned int>* grabCountPtr, ImageWriter* imageWriterPtr, std::ofstream* imageListFilePtr)
 {
-    for (size_t i = 0; i < mDevices.size(); ++i)
+    mFrameHandlers.clear();
+    for (auto camera : {rigPair.left, rigPair.right})
     {
-        mCameras[i].RegisterImageEventHandler
+        mFrameHandlers.push_back(std::unique_ptr<FrameHandler>
         (
-            new CameraCalibration(mCameraNames[i], synchronizedPtr, grabCountPtr, imageListFilePtr, wroteToFilePairPtr),
-            Pylon::RegistrationMode_ReplaceAll,
-            Pylon::Cleanup_Delete
-        );
+            new CameraCalibration(mCameraNames[camera], mFrameSource->getImageSize(camera), stereoSynchronizerPtr, stereoCalibratorPtr, grabCountPtr, imageWriterPtr, imageListFilePtr, mHeadless)
+        ));
     }
 }
 
-void Application::registerCameraCapture(SV::StereoPhoto* stereoPhotoPtr)
+void Application::registerCameraCapture(const SV::RigPair& rigPair, StereoPipeline* stereoPipelinePtr, std::shared_ptr<const CalibrationBundle> calibrationBundle)
 {
-    for (size_t i = 0; i < mDevices.size(); ++i)
+    // Camera 0 of the pair rectifies with the left maps of its bundle, camera 1 with the right ones
+    size_t camera = 0u;
+    for (auto sourceCamera : {rigPair.left, rigPair.right})
     {
-        stereoPhotoPtr->cameras[i] = mCameraNames[i];
-        mCameras[i].RegisterImageEventHandler
+        mFrameHandlers.push_back(std::unique_ptr<FrameHandler>
         (
-            new CameraCapture(mCameraNames[i], stereoPhotoPtr),
-            Pylon::RegistrationMode_ReplaceAll,
-            Pylon::Cleanup_Delete
-        );
+            new CameraCapture(mCameraNames[sourceCamera], camera++, mFrameSource->getImageSize(sourceCamera), calibrationBundle, stereoPipelinePtr)
+        ));
     }
 }
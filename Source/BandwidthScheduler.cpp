@@ -0,0 +1,89 @@
+#include <SV/BandwidthScheduler.hpp>
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+    // IP (20), UDP (8) and GVSP (8) headers are part of GevSCPSPacketSize
+    const int PACKET_HEADERS    = 36;
+    // GVSP leader and trailer packets of each frame
+    const size_t FRAME_PACKETS  = 2u;
+}
+
+
+BandwidthScheduler::BandwidthScheduler(double linkBandwidth, double margin)
+: mLinkBandwidth(linkBandwidth)
+, mMargin(margin)
+{
+    if (mLinkBandwidth <= 0. || mMargin < 0. || mMargin >= 1.)
+        throw std::runtime_error("BandwidthScheduler::BandwidthScheduler() - Expected a positive bandwidth and a margin in [0, 1)");
+}
+
+BandwidthScheduler::Schedule BandwidthScheduler::compute(const std::vector<SV::StreamParameters>& streams, double processingPeriod) const
+{
+    Schedule schedule;
+    schedule.framePeriod = 0.;
+    schedule.linkPeriod = 0.;
+    if (streams.empty())
+        return schedule;
+
+    std::vector<double> packetTimes;
+    std::vector<size_t> packets;
+    for (auto& stream : streams)
+    {
+        packetTimes.push_back(getPacketTime(stream));
+        packets.push_back(getPacketsPerFrame(stream));
+        schedule.linkPeriod += packetTimes.back() * packets.back();
+    }
+    auto cycleTime = std::accumulate(packetTimes.begin(), packetTimes.end(), 0.);
+
+    // Only the fraction of the link outside the margin is planned
+    schedule.framePeriod = std::max(schedule.linkPeriod / (1. - mMargin), processingPeriod);
+
+    // Interleaving needs a gap of one packet of every other camera; a slower pipeline stretches the gaps
+    std::vector<double> gaps;
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        auto interleaveGap = cycleTime - packetTimes[i];
+        auto spreadGap = schedule.framePeriod * (1. - mMargin) / packets[i] - packetTimes[i];
+        gaps.push_back(std::max(interleaveGap, spreadGap));
+    }
+
+    // Offsets spread the first packets evenly over the shortest cycle
+    double shortestCycle = packetTimes[0] + gaps[0];
+    for (size_t i = 1; i < streams.size(); ++i)
+        shortestCycle = std::min(shortestCycle, packetTimes[i] + gaps[i]);
+
+    for (size_t i = 0; i < streams.size(); ++i)
+    {
+        SV::TransportDelays delays;
+        delays.interPacketDelay = (int64_t) std::ceil(gaps[i] * streams[i].tickFrequency);
+        delays.frameTransmissionDelay = (int64_t) std::llround(i * shortestCycle / streams.size() * streams[i].tickFrequency);
+        schedule.delays.push_back(delays);
+    }
+    return schedule;
+}
+
+size_t BandwidthScheduler::getPacketsPerFrame(const SV::StreamParameters& stream)
+{
+    auto payload = stream.packetSize - PACKET_HEADERS;
+    if (payload <= 0)
+        throw std::runtime_error("BandwidthScheduler::getPacketsPerFrame() - Packet size too small");
+
+    auto frameBytes = (size_t) stream.imageSize.area() * stream.bitsPerPixel / 8u;
+    return (frameBytes + payload - 1u) / payload + FRAME_PACKETS;
+}
+
+double BandwidthScheduler::getPacketTime(const SV::StreamParameters& stream) const
+{
+    return (stream.packetSize + SV::ETHERNET_FRAMING) / mLinkBandwidth;
+}
+
+double BandwidthScheduler::getLinkBandwidth() const
+{
+    return mLinkBandwidth;
+}
@@ -0,0 +1,217 @@
+#include <SV/CalibrationBundle.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace
+{
+    const uint64_t DATA_ALIGNMENT = 64u;
+
+    uint64_t alignUp(uint64_t value)
+    {
+        return (value + DATA_ALIGNMENT - 1u) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+    }
+}
+
+const char          CalibrationBundle::MAGIC[8] = {'S', 'V', 'C', 'A', 'L', 'I', 'B', '\0'};
+const uint32_t      CalibrationBundle::VERSION = 1u;
+const std::string   CalibrationBundle::FILE_NAME = "calibration.bin";
+
+CalibrationBundle::CalibrationBundle()
+: mMatrices()
+, mMapping(nullptr)
+, mMappingSize(0u)
+{
+}
+
+CalibrationBundle::~CalibrationBundle()
+{
+    mMatrices.clear();
+    if (mMapping != nullptr)
+        munmap(mMapping, mMappingSize);
+}
+
+std::shared_ptr<const CalibrationBundle> CalibrationBundle::loadBinaryFile(const std::string& bundleFile)
+{
+    int fd = open(bundleFile.c_str(), O_RDONLY);
+    if (fd == -1)
+        return std::shared_ptr<const CalibrationBundle>();
+
+    struct stat fileStatus;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &fileStatus) == 0 && fileStatus.st_size >= (off_t) sizeof(Header))
+        mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        std::cout << "CalibrationBundle::loadBinaryFile() - Failed to map " << bundleFile << std::endl;
+        return std::shared_ptr<const CalibrationBundle>();
+    }
+
+    std::shared_ptr<CalibrationBundle> bundle(new CalibrationBundle());
+    bundle->mMapping = mapping;
+    bundle->mMappingSize = fileStatus.st_size;
+
+    auto data = static_cast<const unsigned char*>(mapping);
+    auto header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION)
+    {
+        std::cout << "CalibrationBundle::loadBinaryFile() - " << bundleFile << " is not a version " << VERSION << " bundle" << std::endl;
+        return std::shared_ptr<const CalibrationBundle>();
+    }
+
+    auto entriesSize = (uint64_t) header->numberOfEntries * sizeof(Entry);
+    if (sizeof(Header) + entriesSize > bundle->mMappingSize)
+    {
+        std::cout << "CalibrationBundle::loadBinaryFile() - " << bundleFile << " is truncated" << std::endl;
+        return std::shared_ptr<const CalibrationBundle>();
+    }
+
+    auto entries = reinterpret_cast<const Entry*>(data + sizeof(Header));
+    for (uint32_t i = 0; i < header->numberOfEntries; ++i)
+    {
+        const Entry& entry = entries[i];
+        auto expectedSize = (uint64_t) entry.rows * entry.cols * CV_ELEM_SIZE(entry.type);
+        if (entry.rows <= 0 || entry.cols <= 0 || entry.size != expectedSize || entry.offset + entry.size > bundle->mMappingSize)
+        {
+            std::cout << "CalibrationBundle::loadBinaryFile() - " << bundleFile << " has a corrupted entry" << std::endl;
+            return std::shared_ptr<const CalibrationBundle>();
+        }
+
+        // Read-only mapping: the matrix header must never be written through
+        auto matrixData = const_cast<unsigned char*>(data + entry.offset);
+        bundle->mMatrices.push_back(NamedMatrix(std::string(entry.name, strnlen(entry.name, sizeof(entry.name))), cv::Mat(entry.rows, entry.cols, entry.type, matrixData)));
+    }
+
+    return bundle;
+}
+
+std::shared_ptr<const CalibrationBundle> CalibrationBundle::loadXMLFiles(const std::string& xmlFilesPath, const std::vector<std::string>& names)
+{
+    std::shared_ptr<CalibrationBundle> bundle(new CalibrationBundle());
+    for (auto& name : names)
+    {
+        cv::Mat matrix;
+        cv::FileStorage fs(xmlFilesPath + name + ".xml", cv::FileStorage::READ);
+        if (!fs.isOpened())
+        {
+            std::cout << "CalibrationBundle::loadXMLFiles() - Failed to open " << xmlFilesPath + name + ".xml" << std::endl;
+            return std::shared_ptr<const CalibrationBundle>();
+        }
+        fs[name] >> matrix;
+        fs.release();
+        bundle->mMatrices.push_back(NamedMatrix(name, matrix));
+    }
+
+    return bundle;
+}
+
+std::shared_ptr<const CalibrationBundle> CalibrationBundle::createFromMatrices(const std::vector<NamedMatrix>& matrices)
+{
+    std::shared_ptr<CalibrationBundle> bundle(new CalibrationBundle());
+    bundle->mMatrices = matrices;
+
+    return bundle;
+}
+
+void CalibrationBundle::saveBinaryFile(const std::string& bundleFile, const std::vector<NamedMatrix>& matrices)
+{
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.numberOfEntries = matrices.size();
+
+    std::vector<Entry> entries(matrices.size());
+    auto offset = alignUp(sizeof(Header) + entries.size() * sizeof(Entry));
+    for (size_t i = 0; i < matrices.size(); ++i)
+    {
+        const cv::Mat& matrix = matrices[i].second;
+        if (matrices[i].first.size() >= sizeof(entries[i].name))
+            throw std::runtime_error("CalibrationBundle::saveBinaryFile() - Matrix name too long: " + matrices[i].first);
+
+        std::memset(&entries[i], 0, sizeof(Entry));
+        std::strncpy(entries[i].name, matrices[i].first.c_str(), sizeof(entries[i].name) - 1u);
+        entries[i].rows = matrix.rows;
+        entries[i].cols = matrix.cols;
+        entries[i].type = matrix.type();
+        entries[i].offset = offset;
+        entries[i].size = (uint64_t) matrix.rows * matrix.cols * matrix.elemSize();
+        offset = alignUp(offset + entries[i].size);
+    }
+
+    // Written aside and renamed, so a reader never maps a half-written bundle
+    std::string temporaryFile(bundleFile + ".tmp");
+    std::ofstream file(temporaryFile, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("CalibrationBundle::saveBinaryFile() - Failed to open " + temporaryFile);
+
+    const char padding[DATA_ALIGNMENT] = {0};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(Entry));
+    uint64_t position = sizeof(Header) + entries.size() * sizeof(Entry);
+    for (size_t i = 0; i < matrices.size(); ++i)
+    {
+        file.write(padding, entries[i].offset - position);
+        const cv::Mat& matrix = matrices[i].second;
+        auto rowSize = matrix.cols * matrix.elemSize();
+        for (int row = 0; row < matrix.rows; ++row)
+            file.write(reinterpret_cast<const char*>(matrix.ptr(row)), rowSize);
+        position = entries[i].offset + entries[i].size;
+    }
+    file.close();
+
+    if (!file || std::rename(temporaryFile.c_str(), bundleFile.c_str()) != 0)
+        throw std::runtime_error("CalibrationBundle::saveBinaryFile() - Failed to write " + bundleFile);
+}
+
+cv::Mat CalibrationBundle::getMatrix(const std::string& name) const
+{
+    for (auto& matrix : mMatrices)
+    {
+        if (matrix.first == name)
+            return matrix.second;
+    }
+
+    return cv::Mat();
+}
+
+const std::vector<CalibrationBundle::NamedMatrix>& CalibrationBundle::getMatrices() const
+{
+    return mMatrices;
+}
+
+bool CalibrationBundle::isMemoryMapped() const
+{
+    return mMapping != nullptr;
+}
+
+uint64_t CalibrationBundle::getChecksum() const
+{
+    // 64-bit FNV-1a over names, shapes and data
+    uint64_t checksum = 14695981039346656037ull;
+    auto hash = [&checksum](const void* data, size_t size)
+    {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i)
+            checksum = (checksum ^ bytes[i]) * 1099511628211ull;
+    };
+
+    for (auto& matrix : mMatrices)
+    {
+        auto& m = matrix.second;
+        int shape[] = {m.rows, m.cols, m.type()};
+        hash(matrix.first.data(), matrix.first.size());
+        hash(shape, sizeof(shape));
+        for (int row = 0; row < m.rows; ++row)
+            hash(m.ptr(row), m.cols * m.elemSize());
+    }
+    return checksum;
+}
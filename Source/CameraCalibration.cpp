@@ -1,8 +1,9 @@
 #include <SV/CameraCalibration.hpp>
 #include <SV/Utility.hpp>
-
-#include <pylon/InstantCamera.h>
-#include <pylon/GrabResultPtr.h>
+#include <SV/ImageProcessing.hpp>
+#include <SV/StereoSynchronizer.hpp>
+#include <SV/StereoCalibrator.hpp>
+#include <SV/ImageWriter.hpp>
 
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
@@ -10,102 +11,135 @@
 
 #include <iostream>
 #include <fstream>
+#include <utility>
+
+
+namespace
+{
+    // Frame Buffers
+    const size_t GRAY_BUFFER            = 0;
+    const size_t BINARY_BUFFER          = 1;
+    const size_t DISPLAY_BUFFER         = 2;
+    const size_t DISPLAY_HALF_BUFFER    = 3;
+}
 
 
-CameraCalibration::CameraCalibration(std::string cameraName, bool* synchronizedPtr, unsigned int* grabCountPtr, std::ofstream* imageListFilePtr, std::pair<bool, bool>* wroteToFilePairPtr)
+CameraCalibration::CameraCalibration(std::string cameraName, cv::Size imageSize, StereoSynchronizer* stereoSynchronizerPtr, StereoCalibrator* stereoCalibratorPtr, std::atomic<unsigned int>* grabCountPtr, ImageWriter* imageWriterPtr, std::ofstream* imageListFilePtr, bool headless)
 : mCameraName(cameraName)
-, mSynchronizedPtr(synchronizedPtr)
+, mHeadless(headless)
+, mStereoSynchronizerPtr(stereoSynchronizerPtr)
+, mStereoCalibratorPtr(stereoCalibratorPtr)
 , mGrabCountPtr(grabCountPtr)
+, mImageWriterPtr(imageWriterPtr)
 , mImageListFilePtr(imageListFilePtr)
-, mWroteToFilePairPtr(wroteToFilePairPtr)
 , mPatternSize()
 , mThreshold(0.f)
+, mImageSize()
+, mFrameBufferPool(SV::FRAME_BUFFER_HUGE_PAGES)
+, mCorners()
 {
-	cv::namedWindow(mCameraName, CV_WINDOW_AUTOSIZE);
+    if (!mHeadless)
+        cv::namedWindow(mCameraName, CV_WINDOW_AUTOSIZE);
 
 	auto calibrationPattern = SV::loadCalibrationPatternFile();
     mPatternSize.width = calibrationPattern.w;
     mPatternSize.height = calibrationPattern.h;
+    mCorners.reserve(mPatternSize.area());
+
+    if (imageSize.area() > 0)
+        allocateBuffers(imageSize);
 }
 
-void CameraCalibration::OnImageGrabbed(Pylon::CInstantCamera& camera, const Pylon::CGrabResultPtr& grabResultPtr)
-{    
-	if (grabResultPtr->GrabSucceeded())
-    {       
-        std::string imagePath;
-        SV::EMULATION_MODE ? imagePath = SV::EMULATED_IMAGES_PATH : imagePath = SV::CALIBRATION_IMAGES_PATH;
-        
-        if (*mGrabCountPtr < 10u)
-            imagePath += "0";
-        imagePath += std::to_string(*mGrabCountPtr);        
-        
-        auto cameraContextValue = grabResultPtr->GetCameraContext();        
-        // Left Image
-        if (cameraContextValue == 0)
-        {
-           	imagePath += SV::CALIBRATION_IMAGE_LEFT;
-            if (!mWroteToFilePairPtr->first)
-            {
-                *mImageListFilePtr << imagePath << std::endl;            
-                mWroteToFilePairPtr->first = true;            
-            }
-        }
-        // Right Image
-        else if (cameraContextValue == 1)
-        {
-            imagePath += SV::CALIBRATION_IMAGE_RIGHT;
-            if (!mWroteToFilePairPtr->second)
-            {
-                *mImageListFilePtr << imagePath << std::endl;            
-                mWroteToFilePairPtr->second = true;
-            }
-        }        
-        
-        // OpenCV image CV_8U: 8-bits, 1 channel        
-        auto imageCamera = cv::Mat(grabResultPtr->GetHeight(), grabResultPtr->GetWidth(), CV_8UC1, grabResultPtr->GetBuffer());
-        auto imageGray = cv::Mat(grabResultPtr->GetHeight(), grabResultPtr->GetWidth(), CV_8UC1);
-        auto image = cv::Mat(grabResultPtr->GetHeight(), grabResultPtr->GetWidth(), CV_8UC1);
-        auto imageShow = cv::Mat(grabResultPtr->GetHeight(), grabResultPtr->GetWidth(), CV_8UC3);
-
-        if (SV::EMULATION_MODE)
-            imageCamera = cv::imread(imagePath);
-        else
-            cv::cvtColor(imageCamera, imageCamera, CV_BayerGB2RGB); 
-
-        cv::cvtColor(imageCamera, imageGray, CV_BGR2GRAY);        
-        cv::threshold(imageGray, image, mThreshold, 255, CV_THRESH_BINARY + CV_THRESH_OTSU);
-
-        
-        std::vector<cv::Point2f> corners;
-        auto foundChessboardCorners = cv::findChessboardCorners(image, mPatternSize, corners,
-                cv::CALIB_CB_ADAPTIVE_THRESH + cv::CALIB_CB_NORMALIZE_IMAGE);
-        cv::cvtColor(image, imageShow, CV_GRAY2BGR);     
-
-        // Save image only if found chessboard corners               
-        if (foundChessboardCorners)
+void CameraCalibration::onFrameGrabbed(const SV::Frame& frame)
+{
+    auto cameraContextValue = frame.camera;        
+    auto imageCamera = frame.image;
+    auto pixelFormat = frame.pixelFormat;
+    if (SV::EMULATION_MODE)
+    {
+        imageCamera = cv::imread(getImagePath(SV::EMULATED_IMAGES_PATH, mGrabCountPtr->load(), cameraContextValue));
+        pixelFormat = SV::PIXEL_FORMAT_BGR8;
+    }
+
+    auto imageGraySize = SV::getGraySize(imageCamera.size(), pixelFormat, SV::BAYER_2X2_BINNING);
+    if (imageGraySize != mImageSize)
+        allocateBuffers(imageGraySize);
+
+    auto imageGray = mFrameBufferPool.getBuffer(GRAY_BUFFER);
+    auto image = mFrameBufferPool.getBuffer(BINARY_BUFFER);
+    auto imageShow = mFrameBufferPool.getBuffer(DISPLAY_BUFFER);
+    auto imageShowHalf = mFrameBufferPool.getBuffer(DISPLAY_HALF_BUFFER);
+    SV::convertToGray(imageCamera, pixelFormat, imageGray, SV::BAYER_2X2_BINNING);
+
+    cv::threshold(imageGray, image, mThreshold, 255, CV_THRESH_BINARY + CV_THRESH_OTSU);
+
+    
+    auto& corners = mCorners;
+    auto foundChessboardCorners = SV::findChessboardCornersCoarseToFine(image, mPatternSize, corners, SV::CHESSBOARD_PYRAMID_LEVELS);
+
+    // Only views with chessboard corners are candidates; keep them once the other camera saw the same instant
+    if (foundChessboardCorners && mStereoCalibratorPtr->isCollecting())
+    {
+        std::shared_ptr<SV::CalibrationView> calibrationView(new SV::CalibrationView());
+        calibrationView->image = image.clone();
+        calibrationView->corners = corners;
+
+        SV::Frame view;
+        view.image = calibrationView->image;
+        view.owner = calibrationView;
+        view.camera = cameraContextValue;
+        view.id = frame.id;
+        view.timestamp = frame.timestamp;
+        view.pixelFormat = SV::PIXEL_FORMAT_MONO8;
+
+        SV::Frame left, right;
+        if (mStereoSynchronizerPtr->push(std::move(view), left, right))
         {
-            cv::imwrite(imagePath, image);                    
-            std::cout << "Photo [" << imagePath << "] saved." << std::endl;
-            if (cameraContextValue == 0)
-                *mSynchronizedPtr = true;
-            if (cameraContextValue == 1 && *mSynchronizedPtr)
+            // The calibrator works on these corners in memory; the images on disk only feed the StereoCalibration module
+            auto leftView = std::static_pointer_cast<SV::CalibrationView>(left.owner);
+            auto rightView = std::static_pointer_cast<SV::CalibrationView>(right.owner);
+            mStereoCalibratorPtr->addView(left.image.size(), leftView->corners, rightView->corners);
+
+            auto grabCount = mGrabCountPtr->load();
+            auto imagesPath = SV::EMULATION_MODE ? SV::EMULATED_IMAGES_PATH : SV::CALIBRATION_IMAGES_PATH;
+            // The writer thread takes the views (and their buffers) over; the list is flushed when calibration closes it
+            for (auto& pairedView : {left, right})
             {
-                *mGrabCountPtr += 1u;
-                *mSynchronizedPtr = false;                                
-                mWroteToFilePairPtr->first = false;
-                mWroteToFilePairPtr->second = false;
+                auto imagePath = getImagePath(imagesPath, grabCount, pairedView.camera);
+                mImageWriterPtr->write(imagePath, pairedView);
+                *mImageListFilePtr << imagePath << '\n';
             }
-            drawChessboardCorners(imageShow, mPatternSize, cv::Mat(corners), foundChessboardCorners);            
+            mGrabCountPtr->store(grabCount + 1u);
         }
-        else
-        {            
-            *mSynchronizedPtr = false;
-        }
-        cv::resize(imageShow, imageShow, cv::Size(image.cols / 2, image.rows / 2));
-        cv::imshow(mCameraName, imageShow);
     }
-    else
+    if (mHeadless)
+        return;
+
+    cv::cvtColor(image, imageShow, CV_GRAY2BGR);     
+    if (foundChessboardCorners)
+        drawChessboardCorners(imageShow, mPatternSize, cv::Mat(corners), foundChessboardCorners);
+    cv::resize(imageShow, imageShowHalf, imageShowHalf.size());
+    cv::imshow(mCameraName, imageShowHalf);
+}
+
+std::string CameraCalibration::getImagePath(const std::string& imagesPath, unsigned int grabCount, size_t camera)
+{
+    std::string imagePath(imagesPath);
+    if (grabCount < 10u)
+        imagePath += "0";
+    imagePath += std::to_string(grabCount);
+    imagePath += camera == 0 ? SV::CALIBRATION_IMAGE_LEFT : SV::CALIBRATION_IMAGE_RIGHT;
+    return imagePath;
+}
+
+void CameraCalibration::allocateBuffers(cv::Size imageSize)
+{
+    mFrameBufferPool.allocate(
     {
-        std::cout << mCameraName << "CameraCalibration::OnImageGrabbed() ERROR: " << grabResultPtr->GetErrorCode() << " " << grabResultPtr->GetErrorDescription() << std::endl;
-    }
-}
\ No newline at end of file
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC1),
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC1),
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC3),
+        FrameBufferPool::BufferLayout(cv::Size(imageSize.width / 2, imageSize.height / 2), CV_8UC3)
+    });
+    mImageSize = imageSize;
+}
@@ -7,12 +7,11 @@
 #include <GenApi/Types.h>
 
 #include <iostream>
+#include <algorithm>
 
 
-CameraConfiguration::CameraConfiguration(const char* configurationFile, const int interPacketDelay, int frameTransmissionDelay, std::string cameraName)
+CameraConfiguration::CameraConfiguration(const char* configurationFile, std::string cameraName)
 : mConfigurationFile(configurationFile)     
-, mInterPacketDelay(interPacketDelay)                                   
-, mFrameTransmissionDelay(frameTransmissionDelay)    
 , mCameraName(cameraName)                         
 {
 }
@@ -36,15 +35,22 @@ void CameraConfiguration::OnOpened(Pylon::CInstantCamera& camera)
     std::cout << std::endl;
 
     std::cout << "Packet Size: " << GenApi::CIntegerPtr(nodeMap.GetNode("GevSCPSPacketSize"))->GetValue() << std::endl;
-    GenApi::CIntegerPtr interpacketDelay(nodeMap.GetNode("GevSCPD"));
-    interpacketDelay->SetValue(mInterPacketDelay);
-    GenApi::CIntegerPtr frameTransmissionDelay(nodeMap.GetNode("GevSCFTD"));
-    frameTransmissionDelay->SetValue(mFrameTransmissionDelay);
-    std::cout << "Inter-Packet Delay: " << interpacketDelay->GetValue() << std::endl;
-    std::cout << "Frame Transmission Delay: " << frameTransmissionDelay->GetValue() << std::endl;
+    // Delays from the .pfs until PylonFrameSource schedules them for every camera on the link
+    std::cout << "Inter-Packet Delay: " << GenApi::CIntegerPtr(nodeMap.GetNode("GevSCPD"))->GetValue() << std::endl;
+    std::cout << "Frame Transmission Delay: " << GenApi::CIntegerPtr(nodeMap.GetNode("GevSCFTD"))->GetValue() << std::endl;
 }
 
 void CameraConfiguration::OnGrabStarted(Pylon::CInstantCamera& camera)
 {    
     std::cout << mCameraName << " is Capturing." << std::endl;
 }
+
+void CameraConfiguration::setTransportDelays(Pylon::CInstantCamera& camera, const SV::TransportDelays& transportDelays, const std::string& cameraName)
+{
+    GenApi::INodeMap& nodeMap = camera.GetNodeMap();
+    GenApi::CIntegerPtr interpacketDelay(nodeMap.GetNode("GevSCPD"));
+    GenApi::CIntegerPtr frameTransmissionDelay(nodeMap.GetNode("GevSCFTD"));
+    interpacketDelay->SetValue(std::min(std::max(transportDelays.interPacketDelay, interpacketDelay->GetMin()), interpacketDelay->GetMax()));
+    frameTransmissionDelay->SetValue(std::min(std::max(transportDelays.frameTransmissionDelay, frameTransmissionDelay->GetMin()), frameTransmissionDelay->GetMax()));
+    std::cout << cameraName << " Inter-Packet Delay: " << interpacketDelay->GetValue() << ", Frame Transmission Delay: " << frameTransmissionDelay->GetValue() << std::endl;
+}
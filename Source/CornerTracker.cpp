@@ -0,0 +1,132 @@
+#include <SV/CornerTracker.hpp>
+#include <SV/ImageProcessing.hpp>
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include <cmath>
+#include <utility>
+
+
+namespace
+{
+    // Same refinement as the calibration module: 11x11 window, 30 iterations or 0.01 px
+    const cv::Size SUBPIXEL_WINDOW(5, 5);
+    const cv::TermCriteria SUBPIXEL_CRITERIA(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+
+    float distance(cv::Point2f a, cv::Point2f b)
+    {
+        auto difference = a - b;
+        return std::sqrt(difference.x * difference.x + difference.y * difference.y);
+    }
+}
+
+
+CornerTracker::CornerTracker(cv::Size patternSize, int windowSize, int pyramidLevels, float maximumError, int detectionLevels)
+: mPatternSize(patternSize)
+, mWindowSize(windowSize, windowSize)
+, mPyramidLevels(pyramidLevels)
+, mMaximumError(maximumError)
+, mDetectionLevels(detectionLevels)
+, mTracking(false)
+, mPyramid()
+, mPreviousPyramid()
+, mPreviousCorners()
+, mPatternCorners()
+, mBackTrackedCorners()
+, mProjectedCorners()
+, mStatus()
+, mError()
+, mStatistics()
+{
+    // Ideal corner grid, in pattern order
+    mPatternCorners.reserve(mPatternSize.area());
+    for (int y = 0; y < mPatternSize.height; ++y)
+        for (int x = 0; x < mPatternSize.width; ++x)
+            mPatternCorners.push_back(cv::Point2f((float) x, (float) y));
+}
+
+bool CornerTracker::findCorners(const cv::Mat& image, std::vector<cv::Point2f>& corners)
+{
+    // The pyramid of this frame becomes the starting point of the next one
+    cv::buildOpticalFlowPyramid(image, mPyramid, mWindowSize, mPyramidLevels);
+    if (mTracking && (mPreviousPyramid.empty() || mPreviousPyramid[0].size() != image.size()))
+        mTracking = false;
+
+    auto found = mTracking && track(image, corners);
+    if (found)
+        ++mStatistics.tracked;
+    else
+    {
+        if (mTracking)
+            ++mStatistics.lost;
+        found = detect(image, corners);
+        if (found)
+            ++mStatistics.detected;
+    }
+
+    mTracking = found;
+    if (found)
+        mPreviousCorners.assign(corners.begin(), corners.end());
+    std::swap(mPyramid, mPreviousPyramid);
+    return found;
+}
+
+void CornerTracker::reset()
+{
+    mTracking = false;
+    mPreviousCorners.clear();
+}
+
+CornerTracker::Statistics CornerTracker::getStatistics() const
+{
+    return mStatistics;
+}
+
+bool CornerTracker::track(const cv::Mat& image, std::vector<cv::Point2f>& corners)
+{
+    cv::calcOpticalFlowPyrLK(mPreviousPyramid, mPyramid, mPreviousCorners, corners, mStatus, mError, mWindowSize, mPyramidLevels);
+    for (auto status : mStatus)
+        if (!status)
+            return false;
+
+    // Flowing back must land where the corner came from, or the window slid along an edge
+    cv::calcOpticalFlowPyrLK(mPyramid, mPreviousPyramid, corners, mBackTrackedCorners, mStatus, mError, mWindowSize, mPyramidLevels);
+    for (size_t i = 0; i < corners.size(); ++i)
+        if (!mStatus[i] || distance(mBackTrackedCorners[i], mPreviousCorners[i]) > mMaximumError)
+            return false;
+
+    // Snapping onto the saddle points keeps small flow errors from adding up over a long track
+    refine(image, corners);
+    return fitsPattern(corners);
+}
+
+bool CornerTracker::detect(const cv::Mat& image, std::vector<cv::Point2f>& corners)
+{
+    corners.reserve(mPatternSize.area());
+    auto found = SV::findChessboardCornersCoarseToFine(image, mPatternSize, corners, mDetectionLevels);
+    // Same refinement as tracked corners, so a re-detection does not make the corners jump
+    if (found)
+        refine(image, corners);
+    return found;
+}
+
+void CornerTracker::refine(const cv::Mat& image, std::vector<cv::Point2f>& corners) const
+{
+    cv::cornerSubPix(image, corners, SUBPIXEL_WINDOW, cv::Size(-1, -1), SUBPIXEL_CRITERIA);
+}
+
+bool CornerTracker::fitsPattern(const std::vector<cv::Point2f>& corners)
+{
+    // Rectified images are free of lens distortion, so a planar board maps onto its grid through a homography
+    auto homography = cv::findHomography(mPatternCorners, corners, 0);
+    if (homography.empty())
+        return false;
+
+    cv::perspectiveTransform(mPatternCorners, mProjectedCorners, homography);
+    for (size_t i = 0; i < corners.size(); ++i)
+        if (distance(mProjectedCorners[i], corners[i]) > mMaximumError)
+            return false;
+    return true;
+}
@@ -0,0 +1,102 @@
+#include <SV/DirectoryFrameSource.hpp>
+#include <SV/Utility.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <iostream>
+#include <stdexcept>
+
+
+DirectoryFrameSource::DirectoryFrameSource(std::string imagesPath, bool loop)
+: mImagesPath(imagesPath)
+, mLoop(loop)
+, mOpen(false)
+, mGrabbing(false)
+, mStereoPhotos()
+, mNextFrame(0u)
+{
+    if (!mImagesPath.empty() && mImagesPath[mImagesPath.size() - 1] != '/')
+        mImagesPath += "/";
+}
+
+void DirectoryFrameSource::open()
+{
+    mStereoPhotos.clear();
+    for (unsigned int i = 0; i < 100u; ++i)
+    {
+        std::string imagePath(mImagesPath);
+        if (i < 10u)
+            imagePath += "0";
+        imagePath += std::to_string(i);
+
+        auto leftImage = cv::imread(imagePath + SV::CALIBRATION_IMAGE_LEFT, 0);
+        auto rightImage = cv::imread(imagePath + SV::CALIBRATION_IMAGE_RIGHT, 0);
+        if (leftImage.empty() || rightImage.empty())
+            break;
+        mStereoPhotos.push_back(std::make_pair(leftImage, rightImage));
+    }
+
+    if (mStereoPhotos.empty())
+        throw std::runtime_error("DirectoryFrameSource::open() - No stereo photos found in " + mImagesPath);
+
+    std::cout << SV::lineBreak << "Loaded " << mStereoPhotos.size() << " stereo photos from " << mImagesPath << std::endl;
+    mNextFrame = 0u;
+    mOpen = true;
+}
+
+void DirectoryFrameSource::close()
+{
+    mGrabbing = false;
+    mOpen = false;
+    mStereoPhotos.clear();
+}
+
+bool DirectoryFrameSource::isOpen() const
+{
+    return mOpen;
+}
+
+void DirectoryFrameSource::startGrabbing()
+{
+    mGrabbing = mOpen;
+}
+
+void DirectoryFrameSource::stopGrabbing()
+{
+    mGrabbing = false;
+}
+
+bool DirectoryFrameSource::isGrabbing() const
+{
+    return mGrabbing && (mLoop || mNextFrame < mStereoPhotos.size() * 2u);
+}
+
+bool DirectoryFrameSource::retrieveFrame(SV::Frame& frame, unsigned int timeout)
+{
+    if (!isGrabbing())
+        return false;
+
+    auto photo = (mNextFrame / 2u) % mStereoPhotos.size();
+    auto camera = mNextFrame % 2u;
+    frame.image = camera == 0u ? mStereoPhotos[photo].first : mStereoPhotos[photo].second;
+    frame.camera = camera;
+    frame.id = mNextFrame / 2u;
+    frame.timestamp = frame.id;
+    frame.pixelFormat = SV::PIXEL_FORMAT_MONO8;
+    frame.owner.reset();
+    ++mNextFrame;
+
+    return true;
+}
+
+size_t DirectoryFrameSource::getNumberOfCameras() const
+{
+    return 2u;
+}
+
+cv::Size DirectoryFrameSource::getImageSize(size_t camera) const
+{
+    if (mStereoPhotos.empty())
+        return cv::Size();
+    return camera == 0u ? mStereoPhotos[0].first.size() : mStereoPhotos[0].second.size();
+}
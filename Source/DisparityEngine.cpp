@@ -0,0 +1,370 @@
+#include <SV/DisparityEngine.hpp>
+
+#include <limits>
+#include <cstdlib>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    // Larger than any window sum: 255 * 11 * 11 still fits a signed 16-bit lane
+    const int16_t MAXIMUM_COST      = std::numeric_limits<int16_t>::max();
+    const int MAXIMUM_WINDOW_SIZE   = 11;
+
+#if defined(__AVX2__)
+    // 16 signed 16-bit lanes
+    typedef __m256i Vector;
+    const int LANES = 16;
+
+    // |left - right[i]| for the next 16 bytes of right
+    inline Vector loadCost(__m128i left, const uint8_t* right)
+    {
+        auto y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right));
+        return _mm256_cvtepu8_epi16(_mm_or_si128(_mm_subs_epu8(left, y), _mm_subs_epu8(y, left)));
+    }
+    inline Vector load(const int16_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    inline void store(int16_t* p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    inline Vector set(int16_t value) { return _mm256_set1_epi16(value); }
+    inline Vector add(Vector a, Vector b) { return _mm256_add_epi16(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm256_sub_epi16(a, b); }
+    inline Vector minimum(Vector a, Vector b) { return _mm256_min_epi16(a, b); }
+    inline int16_t horizontalMinimum(Vector v)
+    {
+        auto m = _mm_min_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        m = _mm_min_epi16(m, _mm_shuffle_epi32(m, 0x4E));
+        m = _mm_min_epi16(m, _mm_shuffle_epi32(m, 0xB1));
+        m = _mm_min_epi16(m, _mm_shufflelo_epi16(m, 0xB1));
+        return (int16_t) _mm_cvtsi128_si32(m);
+    }
+    inline Vector lessThan(Vector a, Vector b) { return _mm256_cmpgt_epi16(b, a); }
+    inline Vector equal(Vector a, Vector b) { return _mm256_cmpeq_epi16(a, b); }
+    inline Vector select(Vector mask, Vector a, Vector b) { return _mm256_blendv_epi8(b, a, mask); }
+    inline Vector laneIndices() { return _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+#elif defined(__SSE2__)
+    // 8 signed 16-bit lanes
+    typedef __m128i Vector;
+    const int LANES = 8;
+
+    // |left - right[i]| for the next 8 bytes of right
+    inline Vector loadCost(__m128i left, const uint8_t* right)
+    {
+        auto y = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(right));
+        return _mm_unpacklo_epi8(_mm_or_si128(_mm_subs_epu8(left, y), _mm_subs_epu8(y, left)), _mm_setzero_si128());
+    }
+    inline Vector load(const int16_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    inline void store(int16_t* p, Vector v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    inline Vector set(int16_t value) { return _mm_set1_epi16(value); }
+    inline Vector add(Vector a, Vector b) { return _mm_add_epi16(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm_sub_epi16(a, b); }
+    inline Vector minimum(Vector a, Vector b) { return _mm_min_epi16(a, b); }
+    inline int16_t horizontalMinimum(Vector m)
+    {
+        m = _mm_min_epi16(m, _mm_shuffle_epi32(m, 0x4E));
+        m = _mm_min_epi16(m, _mm_shuffle_epi32(m, 0xB1));
+        m = _mm_min_epi16(m, _mm_shufflelo_epi16(m, 0xB1));
+        return (int16_t) _mm_cvtsi128_si32(m);
+    }
+    inline Vector lessThan(Vector a, Vector b) { return _mm_cmplt_epi16(a, b); }
+    inline Vector equal(Vector a, Vector b) { return _mm_cmpeq_epi16(a, b); }
+    inline Vector select(Vector mask, Vector a, Vector b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+    inline Vector laneIndices() { return _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7); }
+#endif
+
+    inline int16_t absoluteDifference(uint8_t a, uint8_t b)
+    {
+        return (int16_t) (a > b ? a - b : b - a);
+    }
+
+    // Rows outside the image repeat the border row
+    inline int clampRow(int row, int rows)
+    {
+        return std::min(std::max(row, 0), rows - 1);
+    }
+
+    // reversed[i] = row[width - 1 - i], so row[x - d] = reversed[width - 1 - x + d] walks forward with d
+    inline void reverseRow(const uint8_t* row, int width, uint8_t* reversed)
+    {
+        for (int i = 0; i < width; ++i)
+            reversed[i] = row[width - 1 - i];
+    }
+}
+
+
+class DisparityEngine::BandBody : public cv::ParallelLoopBody
+{
+    public:
+        BandBody(DisparityEngine& engine, const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity)
+        : mEngine(engine)
+        , mLeft(left)
+        , mRight(right)
+        , mDisparity(disparity)
+        {
+        }
+
+        virtual void operator()(const cv::Range& range) const
+        {
+            auto rows = mLeft.rows;
+            auto bands = (int) mEngine.mBandBuffers.size();
+            for (int band = range.start; band < range.end; ++band)
+            {
+                auto firstRow = rows * band / bands;
+                auto lastRow = rows * (band + 1) / bands;
+                mEngine.computeBand(mLeft, mRight, mDisparity, firstRow, lastRow, mEngine.mBandBuffers[band]);
+            }
+        }
+
+    private:
+        DisparityEngine&        mEngine;
+        const cv::Mat&          mLeft;
+        const cv::Mat&          mRight;
+        cv::Mat&                mDisparity;
+};
+
+
+DisparityEngine::DisparityEngine(int numberOfDisparities, int windowSize, int textureThreshold, int leftRightTolerance, int bands)
+: mNumberOfDisparities(numberOfDisparities)
+, mWindowSize(windowSize)
+, mTextureThreshold(textureThreshold)
+, mLeftRightTolerance(leftRightTolerance)
+, mBands(bands > 0 ? bands : (int) std::max(std::thread::hardware_concurrency(), 1u))
+, mImageSize()
+, mRowStride(0u)
+, mBandBuffers()
+{
+    if (mNumberOfDisparities <= 0 || mNumberOfDisparities % 16 != 0)
+        throw std::runtime_error("DisparityEngine::DisparityEngine() - Number of disparities must be a positive multiple of 16");
+    if (mWindowSize < 3 || mWindowSize > MAXIMUM_WINDOW_SIZE || mWindowSize % 2 == 0)
+        throw std::runtime_error("DisparityEngine::DisparityEngine() - Window size must be odd, between 3 and 11");
+}
+
+void DisparityEngine::compute(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity)
+{
+    if (left.type() != CV_8UC1 || right.type() != CV_8UC1 || left.size() != right.size())
+        throw std::runtime_error("DisparityEngine::compute() - Expected two 8-bit gray images of the same size");
+
+    if (left.size() != mImageSize)
+        allocate(left.size());
+
+    disparity.create(left.size(), CV_16SC1);
+    cv::parallel_for_(cv::Range(0, (int) mBandBuffers.size()), BandBody(*this, left, right, disparity), (double) mBandBuffers.size());
+}
+
+int DisparityEngine::getNumberOfDisparities() const
+{
+    return mNumberOfDisparities;
+}
+
+void DisparityEngine::allocate(cv::Size imageSize)
+{
+    // Reversed right rows are padded with zeros, so costs with x < d stay bounded (those windows are never used)
+    mRowStride = imageSize.width + mNumberOfDisparities + 32u;
+    // Bands need at least a window of rows to amortize their initialization
+    auto bands = std::max(1, std::min(mBands, imageSize.height / mWindowSize));
+
+    mBandBuffers.assign(bands, BandBuffers());
+    for (auto& buffers : mBandBuffers)
+    {
+        buffers.columnSums.assign(imageSize.width * mNumberOfDisparities, 0);
+        buffers.windowSums.assign(mNumberOfDisparities, 0);
+        buffers.textureColumnSums.assign(imageSize.width, 0);
+        buffers.bestLeft.assign(imageSize.width, 0);
+        buffers.bestLeftDisparity.assign(imageSize.width, 0);
+        buffers.previousCost.assign(imageSize.width, 0);
+        buffers.nextCost.assign(imageSize.width, 0);
+        buffers.bestRight.assign(imageSize.width, 0);
+        buffers.bestRightDisparity.assign(imageSize.width, 0);
+        buffers.reversedRows.assign(2u * mRowStride, 0);
+    }
+    mImageSize = imageSize;
+}
+
+void DisparityEngine::computeBand(const cv::Mat& left, const cv::Mat& right, cv::Mat& disparity, int firstRow, int lastRow, BandBuffers& buffers)
+{
+    const int width = left.cols;
+    const int rows = left.rows;
+    const int radius = mWindowSize / 2;
+    const int numberOfDisparities = mNumberOfDisparities;
+    auto columnSums = buffers.columnSums.data();
+    auto window = buffers.windowSums.data();
+    auto textureColumnSums = buffers.textureColumnSums.data();
+    auto bestLeft = buffers.bestLeft.data();
+    auto bestLeftDisparity = buffers.bestLeftDisparity.data();
+    auto previousCost = buffers.previousCost.data();
+    auto nextCost = buffers.nextCost.data();
+    auto bestRight = buffers.bestRight.data();
+    auto bestRightDisparity = buffers.bestRightDisparity.data();
+    auto reversedIn = buffers.reversedRows.data();
+    auto reversedOut = reversedIn + mRowStride;
+
+    // Adds (sign 1) or removes (sign -1) pixel x of one row pair from the column sums of every disparity
+    auto accumulateColumn = [&](int x, const uint8_t* leftRow, const uint8_t* reversed, int16_t sign)
+    {
+        auto sums = columnSums + x * numberOfDisparities;
+        auto rightRow = reversed + width - 1 - x;
+        for (int d = 0; d < numberOfDisparities; ++d)
+            sums[d] += sign * absoluteDifference(leftRow[x], rightRow[d]);
+    };
+
+    // Moves column x one row down: adds the row entering the window, removes the row leaving it
+    auto slideColumn = [&](int x, const uint8_t* leftIn, const uint8_t* leftOut)
+    {
+        auto sums = columnSums + x * numberOfDisparities;
+        auto rightIn = reversedIn + width - 1 - x;
+        auto rightOut = reversedOut + width - 1 - x;
+        int d = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+        auto valueIn = _mm_set1_epi8((char) leftIn[x]);
+        auto valueOut = _mm_set1_epi8((char) leftOut[x]);
+        for (; d < numberOfDisparities; d += LANES)
+            store(sums + d, add(load(sums + d), subtract(loadCost(valueIn, rightIn + d), loadCost(valueOut, rightOut + d))));
+#endif
+        for (; d < numberOfDisparities; ++d)
+            sums[d] += absoluteDifference(leftIn[x], rightIn[d]) - absoluteDifference(leftOut[x], rightOut[d]);
+        if (x > 0 && x < width - 1)
+            textureColumnSums[x] += std::abs(leftIn[x + 1] - leftIn[x - 1]) - std::abs(leftOut[x + 1] - leftOut[x - 1]);
+    };
+
+    // Best disparity of left pixel x and the costs either side of it
+    auto matchColumn = [&](int x)
+    {
+        int best = MAXIMUM_COST;
+        int d = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+        // Per-lane minimum and its disparity; strict comparison keeps the smallest disparity on ties
+        auto lowest = load(window);
+        auto lowestDisparity = laneIndices();
+        auto step = set((int16_t) LANES);
+        auto disparities = lowestDisparity;
+        for (d = LANES; d < numberOfDisparities; d += LANES)
+        {
+            disparities = add(disparities, step);
+            auto cost = load(window + d);
+            auto better = lessThan(cost, lowest);
+            lowest = minimum(cost, lowest);
+            lowestDisparity = select(better, disparities, lowestDisparity);
+        }
+        best = horizontalMinimum(lowest);
+        d = horizontalMinimum(select(equal(lowest, set((int16_t) best)), lowestDisparity, set(MAXIMUM_COST)));
+#else
+        for (int i = 0; i < numberOfDisparities; ++i)
+        {
+            if (window[i] < best)
+            {
+                best = window[i];
+                d = i;
+            }
+        }
+#endif
+        bestLeft[x] = (int16_t) best;
+        bestLeftDisparity[x] = (int16_t) d;
+        previousCost[x] = d > 0 ? window[d - 1] : MAXIMUM_COST;
+        nextCost[x] = d < numberOfDisparities - 1 ? window[d + 1] : MAXIMUM_COST;
+    };
+
+    std::fill(buffers.columnSums.begin(), buffers.columnSums.end(), 0);
+    std::fill(buffers.textureColumnSums.begin(), buffers.textureColumnSums.end(), 0);
+    for (int k = -radius; k <= radius; ++k)
+    {
+        auto y = clampRow(firstRow + k, rows);
+        auto leftRow = left.ptr<uint8_t>(y);
+        reverseRow(right.ptr<uint8_t>(y), width, reversedIn);
+        for (int x = 0; x < width; ++x)
+            accumulateColumn(x, leftRow, reversedIn, 1);
+        for (int x = 1; x < width - 1; ++x)
+            textureColumnSums[x] += std::abs(leftRow[x + 1] - leftRow[x - 1]);
+    }
+
+    const int firstColumn = numberOfDisparities - 1 + radius;
+    const int lastColumn = width - radius;
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        auto slide = y > firstRow;
+        auto entering = clampRow(y + radius, rows);
+        auto leaving = clampRow(y - radius - 1, rows);
+        auto leftIn = left.ptr<uint8_t>(entering);
+        auto leftOut = left.ptr<uint8_t>(leaving);
+        if (slide)
+        {
+            reverseRow(right.ptr<uint8_t>(entering), width, reversedIn);
+            reverseRow(right.ptr<uint8_t>(leaving), width, reversedOut);
+        }
+
+        // Column sums are slid just ahead of the horizontal running sum, so each column is read once per row
+        std::fill(window, window + numberOfDisparities, 0);
+        for (int x = 0; x <= 2 * radius && x < width; ++x)
+        {
+            if (slide)
+                slideColumn(x, leftIn, leftOut);
+            auto sums = columnSums + x * numberOfDisparities;
+            for (int d = 0; d < numberOfDisparities; ++d)
+                window[d] += sums[d];
+        }
+        for (int x = radius; x < lastColumn; ++x)
+        {
+            if (x > radius)
+            {
+                if (slide)
+                    slideColumn(x + radius, leftIn, leftOut);
+                auto enteringSums = columnSums + (x + radius) * numberOfDisparities;
+                auto leavingSums = columnSums + (x - radius - 1) * numberOfDisparities;
+                int d = 0;
+#if defined(__AVX2__) || defined(__SSE2__)
+                for (; d < numberOfDisparities; d += LANES)
+                    store(window + d, add(load(window + d), subtract(load(enteringSums + d), load(leavingSums + d))));
+#endif
+                for (; d < numberOfDisparities; ++d)
+                    window[d] += enteringSums[d] - leavingSums[d];
+            }
+            if (x >= firstColumn)
+                matchColumn(x);
+        }
+
+        // Right view: every right pixel keeps the cheapest left pixel that claims it (cv::StereoBM's disp12MaxDiff check)
+        std::fill(bestRight, bestRight + width, MAXIMUM_COST);
+        std::fill(bestRightDisparity, bestRightDisparity + width, -1);
+        for (int x = firstColumn; x < lastColumn; ++x)
+        {
+            auto xRight = x - bestLeftDisparity[x];
+            if (bestLeft[x] < bestRight[xRight])
+            {
+                bestRight[xRight] = bestLeft[x];
+                bestRightDisparity[xRight] = bestLeftDisparity[x];
+            }
+        }
+
+        // Texture and left-right checks, then a parabola through the neighbouring costs for the subpixel part
+        auto output = disparity.ptr<short>(y);
+        std::fill(output, output + width, INVALID_DISPARITY);
+        for (int x = firstColumn; x < lastColumn; ++x)
+        {
+            int d = bestLeftDisparity[x];
+            int cost = bestLeft[x];
+            if (mLeftRightTolerance >= 0 && std::abs(bestRightDisparity[x - d] - d) > mLeftRightTolerance)
+                continue;
+
+            int texture = 0;
+            for (int k = -radius; k <= radius; ++k)
+                texture += textureColumnSums[x + k];
+            if (texture < mTextureThreshold)
+                continue;
+
+            int value = d * DISPARITY_SCALE;
+            if (d > 0 && d < numberOfDisparities - 1)
+            {
+                int previous = previousCost[x];
+                int next = nextCost[x];
+                int denominator = previous + next - 2 * cost;
+                if (denominator > 0)
+                    value += std::max(-DISPARITY_SCALE / 2, std::min(DISPARITY_SCALE / 2, (previous - next) * (DISPARITY_SCALE / 2) / denominator));
+            }
+            output[x] = (short) value;
+        }
+    }
+}
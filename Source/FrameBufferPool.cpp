@@ -0,0 +1,112 @@
+#include <SV/FrameBufferPool.hpp>
+
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <sys/mman.h>
+
+
+namespace
+{
+    const size_t CACHE_LINE_SIZE    = 64u;
+    const size_t HUGE_PAGE_SIZE     = 2u * 1024u * 1024u;
+
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1u) / alignment * alignment;
+    }
+}
+
+FrameBufferPool::FrameBufferPool(bool useHugePages)
+: mUseHugePages(useHugePages)
+, mHugePageBacked(false)
+, mMemory(nullptr)
+, mMemorySize(0u)
+, mBuffers()
+{
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    release();
+}
+
+void FrameBufferPool::allocate(const std::vector<BufferLayout>& layouts)
+{
+    release();
+
+    std::vector<size_t> steps, offsets;
+    for (auto& layout : layouts)
+    {
+        auto elementSize = (size_t) CV_ELEM_SIZE(layout.second);
+        steps.push_back(alignUp(layout.first.width * elementSize, CACHE_LINE_SIZE));
+        offsets.push_back(mMemorySize);
+        mMemorySize += steps.back() * layout.first.height;
+    }
+    if (mMemorySize == 0u)
+        return;
+
+    if (mUseHugePages)
+    {
+        mMemorySize = alignUp(mMemorySize, HUGE_PAGE_SIZE);
+        void* memory = mmap(nullptr, mMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED)
+        {
+            mMemory = static_cast<unsigned char*>(memory);
+            mHugePageBacked = true;
+        }
+        else
+        {
+            std::cout << "FrameBufferPool::allocate() - No huge pages reserved, falling back to transparent huge pages" << std::endl;
+        }
+    }
+
+    if (mMemory == nullptr)
+    {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, mUseHugePages ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE, mMemorySize) != 0)
+            throw std::runtime_error("FrameBufferPool::allocate() - Failed to allocate frame buffers");
+        mMemory = static_cast<unsigned char*>(memory);
+#ifdef MADV_HUGEPAGE
+        if (mUseHugePages)
+            madvise(mMemory, mMemorySize, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Touch every page now instead of on the first frames
+    std::memset(mMemory, 0, mMemorySize);
+
+    for (size_t i = 0; i < layouts.size(); ++i)
+        mBuffers.push_back(cv::Mat(layouts[i].first, layouts[i].second, mMemory + offsets[i], steps[i]));
+}
+
+void FrameBufferPool::release()
+{
+    mBuffers.clear();
+    if (mMemory != nullptr)
+    {
+        if (mHugePageBacked)
+            munmap(mMemory, mMemorySize);
+        else
+            free(mMemory);
+    }
+    mMemory = nullptr;
+    mMemorySize = 0u;
+    mHugePageBacked = false;
+}
+
+bool FrameBufferPool::isAllocated() const
+{
+    return mMemory != nullptr;
+}
+
+bool FrameBufferPool::isHugePageBacked() const
+{
+    return mHugePageBacked;
+}
+
+cv::Mat FrameBufferPool::getBuffer(size_t index) const
+{
+    return mBuffers.at(index);
+}
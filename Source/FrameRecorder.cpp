@@ -0,0 +1,252 @@
+#include <SV/FrameRecorder.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+namespace
+{
+    // Polling interval while no chunk is free or full; writing a chunk takes far longer
+    const std::chrono::milliseconds WAIT_INTERVAL(1);
+
+    uint64_t alignUp(uint64_t value)
+    {
+        return (value + SV::RECORDING_ALIGNMENT - 1u) / SV::RECORDING_ALIGNMENT * SV::RECORDING_ALIGNMENT;
+    }
+
+    uint64_t getHostTime()
+    {
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+
+FrameRecorder::FrameRecorder(const std::string& recordingFile, size_t numberOfCameras, size_t chunkSize, size_t chunks)
+: mRecordingFile(recordingFile)
+, mNumberOfCameras(numberOfCameras)
+, mFile(-1)
+, mChunks()
+, mFullChunks(chunks)
+, mFreeChunks(chunks)
+, mChunk(nullptr)
+, mFileSize(SV::RECORDING_ALIGNMENT)
+, mIndex()
+, mRecordedBytes(0u)
+, mWaitTime(0.)
+, mPendingChunks(0u)
+, mFailed(false)
+, mRunning(true)
+, mThread()
+{
+    // One chunk being filled while another is written
+    if (chunks < 2u)
+        throw std::runtime_error("FrameRecorder::FrameRecorder() - Expected at least two chunks");
+
+    mFile = open(mRecordingFile.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+    if (mFile == -1)
+        throw std::runtime_error("FrameRecorder::FrameRecorder() - Failed to create " + mRecordingFile);
+
+    // Until close() writes the index, the header announces none
+    SV::RecordingHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SV::RECORDING_MAGIC, sizeof(SV::RECORDING_MAGIC));
+    header.version = SV::RECORDING_VERSION;
+    header.cameras = (uint32_t) mNumberOfCameras;
+    std::vector<unsigned char> headerPage(SV::RECORDING_ALIGNMENT, 0u);
+    std::memcpy(headerPage.data(), &header, sizeof(header));
+    if (!write(headerPage.data(), headerPage.size(), 0u))
+    {
+        ::close(mFile);
+        throw std::runtime_error("FrameRecorder::FrameRecorder() - Failed to write " + mRecordingFile);
+    }
+
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        mChunks.push_back(std::unique_ptr<Chunk>(new Chunk()));
+        mChunks.back()->buffer.resize(alignUp(chunkSize) + SV::RECORDING_ALIGNMENT);
+        if (i > 0u)
+            mFreeChunks.tryPush(mChunks.back().get());
+    }
+    mChunk = mChunks.front().get();
+    mChunk->size = SV::RECORDING_ALIGNMENT;
+    mChunk->offset = mFileSize;
+
+    mThread = std::thread(&FrameRecorder::run, this);
+}
+
+FrameRecorder::~FrameRecorder()
+{
+    try
+    {
+        close();
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+    }
+}
+
+void FrameRecorder::record(const SV::Frame& frame)
+{
+    if (mFile == -1)
+        throw std::runtime_error("FrameRecorder::record() - Recording already closed");
+
+    auto& image = frame.image;
+    auto rowSize = (size_t) image.cols * image.elemSize();
+    auto imageSize = alignUp(rowSize * image.rows);
+    if (mChunk->frames.size() == SV::RECORDING_CHUNK_FRAMES || (!mChunk->frames.empty() && mChunk->size + imageSize > mChunk->buffer.size()))
+        submitChunk(true);
+    // A frame larger than a chunk gets a chunk of its own
+    if (mChunk->size + imageSize > mChunk->buffer.size())
+        mChunk->buffer.resize(mChunk->size + imageSize);
+
+    auto data = mChunk->buffer.data() + mChunk->size;
+    if (image.isContinuous())
+        std::memcpy(data, image.data, rowSize * image.rows);
+    else
+    {
+        for (int row = 0; row < image.rows; ++row)
+            std::memcpy(data + row * rowSize, image.ptr(row), rowSize);
+    }
+
+    SV::RecordedFrame recordedFrame;
+    std::memset(&recordedFrame, 0, sizeof(recordedFrame));
+    recordedFrame.offset = mChunk->offset + mChunk->size;
+    recordedFrame.id = frame.id;
+    recordedFrame.timestamp = frame.timestamp;
+    recordedFrame.hostTime = getHostTime();
+    recordedFrame.camera = (uint32_t) frame.camera;
+    recordedFrame.pixelFormat = (uint32_t) frame.pixelFormat;
+    recordedFrame.rows = image.rows;
+    recordedFrame.cols = image.cols;
+    recordedFrame.type = image.type();
+    recordedFrame.step = (uint32_t) rowSize;
+    mChunk->frames.push_back(recordedFrame);
+    mChunk->size += imageSize;
+    mRecordedBytes += rowSize * image.rows;
+}
+
+void FrameRecorder::close()
+{
+    if (mFile == -1)
+        return;
+
+    if (!mChunk->frames.empty())
+        submitChunk(false);
+    while (mPendingChunks > 0u)
+        std::this_thread::sleep_for(WAIT_INTERVAL);
+    mRunning = false;
+    mThread.join();
+
+    // Index, then the header pointing at it: a crash in between leaves a recording replayed from its chunk headers
+    auto indexOffset = mFileSize;
+    auto written = !mFailed && write(mIndex.data(), mIndex.size() * sizeof(SV::RecordedFrame), indexOffset);
+    if (written)
+    {
+        SV::RecordingHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, SV::RECORDING_MAGIC, sizeof(SV::RECORDING_MAGIC));
+        header.version = SV::RECORDING_VERSION;
+        header.cameras = (uint32_t) mNumberOfCameras;
+        header.indexOffset = indexOffset;
+        header.frames = mIndex.size();
+        written = fdatasync(mFile) == 0 && write(&header, sizeof(header), 0u);
+    }
+    ::close(mFile);
+    mFile = -1;
+    mChunks.clear();
+
+    if (!written)
+        throw std::runtime_error("FrameRecorder::close() - Failed to write " + mRecordingFile);
+    std::cout << "Recorded " << mIndex.size() << " frames (" << mRecordedBytes / (1024u * 1024u) << " MiB) to " << mRecordingFile << std::endl;
+}
+
+uint64_t FrameRecorder::getRecordedFrames() const
+{
+    return mIndex.size() + (mChunk != nullptr ? mChunk->frames.size() : 0u);
+}
+
+uint64_t FrameRecorder::getRecordedBytes() const
+{
+    return mRecordedBytes;
+}
+
+double FrameRecorder::getWaitTime() const
+{
+    return mWaitTime;
+}
+
+void FrameRecorder::submitChunk(bool reopen)
+{
+    // The header page lists the frames of the chunk
+    SV::RecordingChunkHeader chunkHeader;
+    std::memset(&chunkHeader, 0, sizeof(chunkHeader));
+    std::memcpy(chunkHeader.magic, SV::RECORDING_CHUNK_MAGIC, sizeof(SV::RECORDING_CHUNK_MAGIC));
+    chunkHeader.size = mChunk->size;
+    chunkHeader.frames = (uint32_t) mChunk->frames.size();
+    std::memset(mChunk->buffer.data(), 0, SV::RECORDING_ALIGNMENT);
+    std::memcpy(mChunk->buffer.data(), &chunkHeader, sizeof(chunkHeader));
+    std::memcpy(mChunk->buffer.data() + sizeof(chunkHeader), mChunk->frames.data(), mChunk->frames.size() * sizeof(SV::RecordedFrame));
+    mIndex.insert(mIndex.end(), mChunk->frames.begin(), mChunk->frames.end());
+    mFileSize += mChunk->size;
+
+    ++mPendingChunks;
+    auto chunk = mChunk;
+    mFullChunks.tryPush(std::move(chunk));
+    mChunk = nullptr;
+    if (!reopen)
+        return;
+
+    auto waitStart = std::chrono::steady_clock::now();
+    while (!mFreeChunks.tryPop(mChunk))
+        std::this_thread::sleep_for(WAIT_INTERVAL);
+    mWaitTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+    mChunk->size = SV::RECORDING_ALIGNMENT;
+    mChunk->offset = mFileSize;
+    mChunk->frames.clear();
+}
+
+bool FrameRecorder::write(const void* data, size_t size, uint64_t offset)
+{
+    auto bytes = static_cast<const unsigned char*>(data);
+    while (size > 0u)
+    {
+        auto written = pwrite(mFile, bytes, size, (off_t) offset);
+        if (written <= 0)
+            return false;
+        bytes += written;
+        size -= (size_t) written;
+        offset += (uint64_t) written;
+    }
+    return true;
+}
+
+void FrameRecorder::run()
+{
+    Chunk* chunk = nullptr;
+    while (mRunning || mPendingChunks > 0u)
+    {
+        if (!mFullChunks.tryPop(chunk))
+        {
+            std::this_thread::sleep_for(WAIT_INTERVAL);
+            continue;
+        }
+
+        if (!mFailed && !write(chunk->buffer.data(), chunk->size, chunk->offset))
+        {
+            mFailed = true;
+            std::cout << "FrameRecorder::run() - Failed to write " << mRecordingFile << std::endl;
+        }
+        // Writes the chunk back now and drops it from the page cache, so dirty pages never pile up into a writeback
+        // stall and the recording does not evict everything else; recordings are replayed through their own mapping
+        sync_file_range(mFile, (off_t) chunk->offset, (off_t) chunk->size, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+        posix_fadvise(mFile, (off_t) chunk->offset, (off_t) chunk->size, POSIX_FADV_DONTNEED);
+
+        mFreeChunks.tryPush(std::move(chunk));
+        --mPendingChunks;
+    }
+}
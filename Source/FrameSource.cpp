@@ -0,0 +1,33 @@
+#include <SV/FrameSource.hpp>
+#include <SV/CalibrationBundle.hpp>
+
+
+std::string FrameSource::getCameraName(size_t camera) const
+{
+    // Logging name; the rig renames the cameras of its stereo pairs (SV::getCameraName())
+    return "Camera " + std::to_string(camera);
+}
+
+cv::Size FrameSource::getImageSize(size_t camera) const
+{
+    return cv::Size();
+}
+
+bool FrameSource::isEmulated() const
+{
+    return false;
+}
+
+bool FrameSource::getStreamParameters(size_t camera, SV::StreamParameters& streamParameters) const
+{
+    return false;
+}
+
+void FrameSource::setTransportDelays(size_t camera, const SV::TransportDelays& transportDelays)
+{
+}
+
+std::shared_ptr<const CalibrationBundle> FrameSource::getCalibrationBundle(size_t left, size_t right) const
+{
+    return nullptr;
+}
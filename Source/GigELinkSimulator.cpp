@@ -0,0 +1,132 @@
+#include <SV/GigELinkSimulator.hpp>
+
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+    struct Packet
+    {
+        // Seconds; the whole packet has reached the switch
+        double      arrival;
+        size_t      camera;
+        size_t      frame;
+        size_t      bytes;
+    };
+}
+
+
+GigELinkSimulator::GigELinkSimulator(double linkBandwidth, size_t switchBufferBytes, size_t cameraBufferFrames)
+: mLinkBandwidth(linkBandwidth)
+, mSwitchBufferBytes(switchBufferBytes)
+, mCameraBufferFrames(std::max(cameraBufferFrames, (size_t) 1u))
+{
+    if (mLinkBandwidth <= 0.)
+        throw std::runtime_error("GigELinkSimulator::GigELinkSimulator() - Expected a positive bandwidth");
+}
+
+GigELinkSimulator::Statistics GigELinkSimulator::run(const std::vector<SV::StreamParameters>& streams, const std::vector<SV::TransportDelays>& delays, double framePeriod, double duration) const
+{
+    if (streams.size() != delays.size() || framePeriod <= 0.)
+        throw std::runtime_error("GigELinkSimulator::run() - Expected one delay pair per stream and a positive frame period");
+
+    auto cameras = streams.size();
+    auto frames = (size_t) (duration / framePeriod);
+    Statistics statistics;
+    statistics.frameRates.assign(cameras, 0.);
+    statistics.packets.assign(cameras, 0u);
+    statistics.droppedPackets.assign(cameras, 0u);
+    statistics.incompleteFrames.assign(cameras, 0u);
+    statistics.skippedFrames.assign(cameras, 0u);
+    statistics.maximumBacklog = 0u;
+    statistics.meanLatency = 0.;
+
+    // Cameras: each sends its frames one after the other at its own pace
+    std::vector<Packet> packets;
+    for (size_t i = 0; i < cameras; ++i)
+    {
+        auto bytes = (size_t) (streams[i].packetSize + SV::ETHERNET_FRAMING);
+        auto packetTime = bytes / mLinkBandwidth;
+        auto spacing = packetTime + delays[i].interPacketDelay / streams[i].tickFrequency;
+        auto packetsPerFrame = BandwidthScheduler::getPacketsPerFrame(streams[i]);
+        auto frameDelay = delays[i].frameTransmissionDelay / streams[i].tickFrequency;
+
+        // Finish times of the frames accepted into the camera's buffer
+        std::deque<double> sending;
+        auto cameraFreeAt = 0.;
+        for (size_t k = 0; k < frames; ++k)
+        {
+            auto exposure = k * framePeriod;
+            while (!sending.empty() && sending.front() <= exposure)
+                sending.pop_front();
+            if (sending.size() >= mCameraBufferFrames)
+            {
+                ++statistics.skippedFrames[i];
+                continue;
+            }
+
+            auto start = std::max(exposure + frameDelay, cameraFreeAt);
+            for (size_t j = 0; j < packetsPerFrame; ++j)
+                packets.push_back({ start + j * spacing + packetTime, i, k, bytes });
+            cameraFreeAt = start + packetsPerFrame * spacing;
+            sending.push_back(cameraFreeAt);
+        }
+    }
+    std::stable_sort(packets.begin(), packets.end(), [](const Packet& a, const Packet& b) { return a.arrival < b.arrival; });
+
+    // Switch: one FIFO drained at link speed; (departure, bytes) of the packets still queued
+    std::deque<std::pair<double, size_t>> queue;
+    size_t backlog = 0u;
+    auto linkFreeAt = 0.;
+    // Per camera and frame: last departure, or negative once a packet of it was dropped
+    std::vector<std::vector<double>> completion(cameras, std::vector<double>(frames, 0.));
+    for (auto& packet : packets)
+    {
+        while (!queue.empty() && queue.front().first <= packet.arrival)
+        {
+            backlog -= queue.front().second;
+            queue.pop_front();
+        }
+
+        ++statistics.packets[packet.camera];
+        auto& frameCompletion = completion[packet.camera][packet.frame];
+        if (backlog + packet.bytes > mSwitchBufferBytes)
+        {
+            ++statistics.droppedPackets[packet.camera];
+            frameCompletion = -1.;
+            continue;
+        }
+
+        linkFreeAt = std::max(linkFreeAt, packet.arrival) + packet.bytes / mLinkBandwidth;
+        queue.push_back(std::make_pair(linkFreeAt, packet.bytes));
+        backlog += packet.bytes;
+        statistics.maximumBacklog = std::max(statistics.maximumBacklog, backlog);
+        if (frameCompletion >= 0.)
+            frameCompletion = linkFreeAt;
+    }
+
+    size_t completeFrames = 0u;
+    for (size_t i = 0; i < cameras; ++i)
+    {
+        size_t complete = 0u;
+        for (size_t k = 0; k < frames; ++k)
+        {
+            if (completion[i][k] < 0.)
+                ++statistics.incompleteFrames[i];
+            else if (completion[i][k] > 0.)
+            {
+                ++complete;
+                statistics.meanLatency += completion[i][k] - k * framePeriod;
+            }
+        }
+        statistics.frameRates[i] = duration > 0. ? complete / duration : 0.;
+        completeFrames += complete;
+    }
+    if (completeFrames > 0u)
+        statistics.meanLatency /= completeFrames;
+
+    return statistics;
+}
@@ -0,0 +1,327 @@
+#include <SV/ImageProcessing.hpp>
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <stdexcept>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace
+{
+    /*
+    BayerGB8 (Basler): even rows G B G B ..., odd rows R G R G ...
+    Any 2x2 window of the mosaic holds one R, one B and two G samples, so the luma of the window
+    starting at (x, y) is a weighted sum of four bytes whose weights only depend on the parity of x and y.
+    Weights are BT.601 luma in 8-bit fixed point: R 77, G 75 + 75, B 29 (sum 256).
+    */
+    const unsigned short LUMA_R = 77;
+    const unsigned short LUMA_G = 75;
+    const unsigned short LUMA_B = 29;
+
+    // Weights of top[x], top[x + 1], bottom[x], bottom[x + 1] for even and odd x
+    struct LumaWeights
+    {
+        unsigned short top0[2];
+        unsigned short top1[2];
+        unsigned short bottom0[2];
+        unsigned short bottom1[2];
+    };
+
+    LumaWeights getLumaWeights(int y)
+    {
+        // Even y: [G B; R G] then [B G; G R]. Odd y: [R G; G B] then [G R; B G]
+        if (y % 2 == 0)
+            return {{LUMA_G, LUMA_B}, {LUMA_B, LUMA_G}, {LUMA_R, LUMA_G}, {LUMA_G, LUMA_R}};
+        else
+            return {{LUMA_R, LUMA_G}, {LUMA_G, LUMA_R}, {LUMA_G, LUMA_B}, {LUMA_B, LUMA_G}};
+    }
+
+    // Gray row from the mosaic rows y (top) and y + 1 (bottom); width - 1 pixels are computed
+    void bayerGBToGrayRow(const unsigned char* top, const unsigned char* bottom, unsigned char* gray, int width, int y)
+    {
+        auto w = getLumaWeights(y);
+        int x = 0;
+
+#ifdef __AVX2__
+        auto weightsTop0 = _mm256_set_epi16(w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0]);
+        auto weightsTop1 = _mm256_set_epi16(w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0]);
+        auto weightsBottom0 = _mm256_set_epi16(w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0]);
+        auto weightsBottom1 = _mm256_set_epi16(w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0]);
+        auto rounding = _mm256_set1_epi16(128);
+
+        // 16 pixels per iteration; reads up to x + 16
+        for (; x + 16 < width; x += 16)
+        {
+            auto t0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x)));
+            auto t1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x + 1)));
+            auto b0 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x)));
+            auto b1 = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x + 1)));
+            auto sum = _mm256_add_epi16(_mm256_mullo_epi16(t0, weightsTop0), _mm256_mullo_epi16(t1, weightsTop1));
+            sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b0, weightsBottom0));
+            sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(b1, weightsBottom1));
+            sum = _mm256_srli_epi16(_mm256_add_epi16(sum, rounding), 8);
+            auto packed = _mm256_packus_epi16(sum, sum);
+            packed = _mm256_permute4x64_epi64(packed, 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), _mm256_castsi256_si128(packed));
+        }
+#elif defined(__SSE2__)
+        auto weightsTop0 = _mm_set_epi16(w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0], w.top0[1], w.top0[0]);
+        auto weightsTop1 = _mm_set_epi16(w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0], w.top1[1], w.top1[0]);
+        auto weightsBottom0 = _mm_set_epi16(w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0], w.bottom0[1], w.bottom0[0]);
+        auto weightsBottom1 = _mm_set_epi16(w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0], w.bottom1[1], w.bottom1[0]);
+        auto rounding = _mm_set1_epi16(128);
+        auto zero = _mm_setzero_si128();
+
+        // 16 pixels per iteration; reads up to x + 16
+        for (; x + 16 < width; x += 16)
+        {
+            auto t0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x));
+            auto t1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x + 1));
+            auto b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x));
+            auto b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x + 1));
+
+            auto sumLow = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(t0, zero), weightsTop0), _mm_mullo_epi16(_mm_unpacklo_epi8(t1, zero), weightsTop1));
+            sumLow = _mm_add_epi16(sumLow, _mm_mullo_epi16(_mm_unpacklo_epi8(b0, zero), weightsBottom0));
+            sumLow = _mm_add_epi16(sumLow, _mm_mullo_epi16(_mm_unpacklo_epi8(b1, zero), weightsBottom1));
+            auto sumHigh = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(t0, zero), weightsTop0), _mm_mullo_epi16(_mm_unpackhi_epi8(t1, zero), weightsTop1));
+            sumHigh = _mm_add_epi16(sumHigh, _mm_mullo_epi16(_mm_unpackhi_epi8(b0, zero), weightsBottom0));
+            sumHigh = _mm_add_epi16(sumHigh, _mm_mullo_epi16(_mm_unpackhi_epi8(b1, zero), weightsBottom1));
+
+            sumLow = _mm_srli_epi16(_mm_add_epi16(sumLow, rounding), 8);
+            sumHigh = _mm_srli_epi16(_mm_add_epi16(sumHigh, rounding), 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), _mm_packus_epi16(sumLow, sumHigh));
+        }
+#endif
+
+        for (; x < width - 1; ++x)
+        {
+            auto p = x % 2;
+            gray[x] = (unsigned char) ((w.top0[p] * top[x] + w.top1[p] * top[x + 1] + w.bottom0[p] * bottom[x] + w.bottom1[p] * bottom[x + 1] + 128) >> 8);
+        }
+    }
+
+    // One gray pixel per 2x2 quad [G B; R G]; reads 2 * width bytes of each row
+    void bayerGBToGrayBinnedRow(const unsigned char* top, const unsigned char* bottom, unsigned char* gray, int width)
+    {
+        int x = 0;
+
+#ifdef __SSE2__
+        auto weightsG = _mm_set1_epi16(LUMA_G);
+        auto weightsR = _mm_set1_epi16(LUMA_R);
+        auto weightsB = _mm_set1_epi16(LUMA_B);
+        auto rounding = _mm_set1_epi16(128);
+        auto evenMask = _mm_set1_epi16(0x00FF);
+
+        // 8 pixels (16 mosaic columns) per iteration, twice
+        for (; x + 16 <= width; x += 16)
+        {
+            __m128i sums[2];
+            for (int half = 0; half < 2; ++half)
+            {
+                auto t = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 2 * x + 16 * half));
+                auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 2 * x + 16 * half));
+                auto greens = _mm_add_epi16(_mm_and_si128(t, evenMask), _mm_srli_epi16(b, 8));
+                auto sum = _mm_add_epi16(_mm_mullo_epi16(greens, weightsG), _mm_mullo_epi16(_mm_srli_epi16(t, 8), weightsB));
+                sum = _mm_add_epi16(sum, _mm_mullo_epi16(_mm_and_si128(b, evenMask), weightsR));
+                sums[half] = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 8);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), _mm_packus_epi16(sums[0], sums[1]));
+        }
+#endif
+
+        for (; x < width; ++x)
+            gray[x] = (unsigned char) ((LUMA_G * (top[2 * x] + bottom[2 * x + 1]) + LUMA_B * top[2 * x + 1] + LUMA_R * bottom[2 * x] + 128) >> 8);
+    }
+}
+
+void SV::bayerGBToGray(const cv::Mat& bayer, cv::Mat& imageGray, bool binning)
+{
+    if (bayer.type() != CV_8UC1 || bayer.rows < 2 || bayer.cols < 2)
+        throw std::runtime_error("SV::bayerGBToGray() - Expected an 8-bit Bayer mosaic of at least 2x2 pixels");
+
+    imageGray.create(getGraySize(bayer.size(), PIXEL_FORMAT_BAYERGB8, binning), CV_8UC1);
+    bayerGBToGrayRows(bayer, imageGray, binning, 0, imageGray.rows);
+}
+
+void SV::bayerGBToGrayRows(const cv::Mat& bayer, cv::Mat& imageGray, bool binning, int firstRow, int lastRow)
+{
+    if (binning)
+    {
+        for (int y = firstRow; y < lastRow; ++y)
+            bayerGBToGrayBinnedRow(bayer.ptr(2 * y), bayer.ptr(2 * y + 1), imageGray.ptr(y), imageGray.cols);
+        return;
+    }
+
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        // The last row has no row below; repeat the previous window, computed again so no other band is read
+        auto top = std::min(y, bayer.rows - 2);
+        auto gray = imageGray.ptr(y);
+        bayerGBToGrayRow(bayer.ptr(top), bayer.ptr(top + 1), gray, bayer.cols, top);
+        // Likewise for the last column
+        gray[bayer.cols - 1] = gray[bayer.cols - 2];
+    }
+}
+
+cv::Size SV::getGraySize(cv::Size imageSize, PixelFormat pixelFormat, bool binning)
+{
+    if (binning && pixelFormat == PIXEL_FORMAT_BAYERGB8)
+        return cv::Size(imageSize.width / 2, imageSize.height / 2);
+
+    return imageSize;
+}
+
+void SV::convertToGray(const cv::Mat& image, PixelFormat pixelFormat, cv::Mat& imageGray, bool binning)
+{
+    switch (pixelFormat)
+    {
+        case PIXEL_FORMAT_BAYERGB8:
+            bayerGBToGray(image, imageGray, binning);
+            break;
+        case PIXEL_FORMAT_BGR8:
+            cv::cvtColor(image, imageGray, CV_BGR2GRAY);
+            break;
+        case PIXEL_FORMAT_MONO8:
+        default:
+            imageGray = image;
+            break;
+    }
+}
+
+void SV::convertToGrayRows(const cv::Mat& image, PixelFormat pixelFormat, cv::Mat& imageGray, bool binning, int firstRow, int lastRow)
+{
+    switch (pixelFormat)
+    {
+        case PIXEL_FORMAT_BAYERGB8:
+            bayerGBToGrayRows(image, imageGray, binning, firstRow, lastRow);
+            break;
+        case PIXEL_FORMAT_BGR8:
+        {
+            // Same size and type as the band, so cvtColor writes into imageGray
+            auto band = imageGray.rowRange(firstRow, lastRow);
+            cv::cvtColor(image.rowRange(firstRow, lastRow), band, CV_BGR2GRAY);
+            break;
+        }
+        case PIXEL_FORMAT_MONO8:
+        default:
+            break;
+    }
+}
+
+void SV::countHistogramRows(const cv::Mat& image, Histogram& histogram, int firstRow, int lastRow)
+{
+    // Four partial histograms break the store-to-load dependency of runs of equal pixels
+    std::array<Histogram, 4> partial;
+    for (auto& counts : partial)
+        counts.fill(0u);
+
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        auto pixels = image.ptr(y);
+        int x = 0;
+        for (; x + 4 <= image.cols; x += 4)
+        {
+            ++partial[0][pixels[x]];
+            ++partial[1][pixels[x + 1]];
+            ++partial[2][pixels[x + 2]];
+            ++partial[3][pixels[x + 3]];
+        }
+        for (; x < image.cols; ++x)
+            ++partial[0][pixels[x]];
+    }
+
+    for (size_t i = 0; i < histogram.size(); ++i)
+        histogram[i] = partial[0][i] + partial[1][i] + partial[2][i] + partial[3][i];
+}
+
+double SV::getOtsuThreshold(const Histogram& histogram)
+{
+    // The search of cv::threshold(THRESH_OTSU) on 8-bit images, step for step, so both give the same threshold
+    double total = 0., mu = 0.;
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        total += histogram[i];
+        mu += i * (double) histogram[i];
+    }
+    if (total == 0.)
+        return 0.;
+
+    double scale = 1. / total;
+    mu *= scale;
+    double mu1 = 0., q1 = 0., maxSigma = 0., maxValue = 0.;
+    for (size_t i = 0; i < histogram.size(); ++i)
+    {
+        double p = histogram[i] * scale;
+        mu1 *= q1;
+        q1 += p;
+        double q2 = 1. - q1;
+        if (std::min(q1, q2) < FLT_EPSILON || std::max(q1, q2) > 1. - FLT_EPSILON)
+            continue;
+
+        mu1 = (mu1 + i * p) / q1;
+        double mu2 = (mu - q1 * mu1) / q2;
+        double sigma = q1 * q2 * (mu1 - mu2) * (mu1 - mu2);
+        if (sigma > maxSigma)
+        {
+            maxSigma = sigma;
+            maxValue = (double) i;
+        }
+    }
+
+    return maxValue;
+}
+
+bool SV::findChessboardCornersCoarseToFine(const cv::Mat& image, cv::Size patternSize, std::vector<cv::Point2f>& corners, int levels)
+{
+    const int flags = cv::CALIB_CB_ADAPTIVE_THRESH + cv::CALIB_CB_NORMALIZE_IMAGE;
+    if (levels <= 0)
+        return cv::findChessboardCorners(image, patternSize, corners, flags);
+
+    // Levels are kept per thread, so steady-state detection does not allocate
+    static thread_local std::vector<cv::Mat> pyramid;
+    pyramid.resize(levels);
+    auto level = &image;
+    for (int i = 0; i < levels; ++i)
+    {
+        cv::pyrDown(*level, pyramid[i]);
+        level = &pyramid[i];
+    }
+
+    corners.reserve(patternSize.area());
+    auto found = cv::findChessboardCorners(*level, patternSize, corners, flags);
+
+    // pyrDown centres coarse pixel x on fine pixel 2x
+    auto scale = (float) (1 << levels);
+    for (auto& corner : corners)
+        corner *= scale;
+    if (!found)
+        return false;
+
+    // The search window covers the coarse uncertainty but stays well inside the smallest square
+    auto spacing = (float) std::max(image.cols, image.rows);
+    for (int y = 0; y < patternSize.height; ++y)
+    {
+        for (int x = 0; x < patternSize.width; ++x)
+        {
+            auto i = y * patternSize.width + x;
+            if (x + 1 < patternSize.width)
+                spacing = std::min(spacing, (float) cv::norm(corners[i + 1] - corners[i]));
+            if (y + 1 < patternSize.height)
+                spacing = std::min(spacing, (float) cv::norm(corners[i + patternSize.width] - corners[i]));
+        }
+    }
+    auto radius = std::max(2, std::min(2 * (int) scale, (int) (spacing / 2.0f) - 1));
+
+    cv::cornerSubPix(image, corners, cv::Size(radius, radius), cv::Size(-1, -1),
+        cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01));
+    return true;
+}
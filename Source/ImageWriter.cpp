@@ -0,0 +1,97 @@
+#include <SV/ImageWriter.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+
+#include <chrono>
+#include <utility>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace
+{
+    // Polling interval while the queue is full, empty or being flushed; a disk write takes far longer
+    const std::chrono::milliseconds WAIT_INTERVAL(1);
+
+    bool hasExtension(const std::string& path, const std::string& extension)
+    {
+        return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+    }
+}
+
+
+ImageWriter::ImageWriter(size_t capacity, int pngCompression)
+: mQueue(capacity)
+, mPngParameters{CV_IMWRITE_PNG_COMPRESSION, pngCompression}
+, mPendingWrites(0u)
+, mFailedWrites(0u)
+, mRunning(true)
+, mThread()
+{
+    mThread = std::thread(&ImageWriter::run, this);
+}
+
+ImageWriter::~ImageWriter()
+{
+    flush();
+    mRunning = false;
+    mThread.join();
+}
+
+void ImageWriter::write(const std::string& imagePath, SV::Frame frame)
+{
+    Job job;
+    job.imagePath = imagePath;
+    job.frame = std::move(frame);
+
+    ++mPendingWrites;
+    while (!mQueue.tryPush(std::move(job)))
+        std::this_thread::sleep_for(WAIT_INTERVAL);
+}
+
+void ImageWriter::flush()
+{
+    while (mPendingWrites > 0u)
+        std::this_thread::sleep_for(WAIT_INTERVAL);
+}
+
+size_t ImageWriter::getFailedWrites() const
+{
+    return mFailedWrites;
+}
+
+void ImageWriter::run()
+{
+    Job job;
+    while (mRunning || mPendingWrites > 0u)
+    {
+        if (!mQueue.tryPop(job))
+        {
+            std::this_thread::sleep_for(WAIT_INTERVAL);
+            continue;
+        }
+
+        auto written = false;
+        try
+        {
+            written = hasExtension(job.imagePath, ".png") ?
+                cv::imwrite(job.imagePath, job.frame.image, mPngParameters) : cv::imwrite(job.imagePath, job.frame.image);
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << e.what() << std::endl;
+        }
+
+        if (written)
+            std::cout << "Photo [" << job.imagePath << "] saved." << std::endl;
+        else
+        {
+            ++mFailedWrites;
+            std::cout << "ImageWriter::run() - Failed to write " << job.imagePath << std::endl;
+        }
+
+        // Hands the buffer back before the write counts as done
+        job = Job();
+        --mPendingWrites;
+    }
+}
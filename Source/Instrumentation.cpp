@@ -0,0 +1,171 @@
+#include <SV/Instrumentation.hpp>
+
+#include <iomanip>
+#include <algorithm>
+
+
+namespace
+{
+    const char* STAGE_NAMES[] = {"Grab wait", "Gray", "Threshold", "Remap", "Match", "Detection", "Triangulation", "Drawing", "Display"};
+    const char* COUNTER_NAMES[] = {"Grabbed", "Rectified", "Paired", "Presented", "Dropped (saturated)", "Dropped (pair busy)", "Dropped (resize)",
+                                   "No disparity (saturated)", "Dropped (out of order)", "Dropped (display)"};
+
+    int highestBit(uint64_t value)
+    {
+        return 63 - __builtin_clzll(value);
+    }
+
+    double toMilliseconds(uint64_t nanoseconds)
+    {
+        return nanoseconds / 1e6;
+    }
+}
+
+
+LatencyHistogram::LatencyHistogram()
+: mCount(0u)
+, mSum(0u)
+, mMaximum(0u)
+{
+    for (auto& bucket : mBuckets)
+        bucket.store(0u, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds)
+{
+    mBuckets[getBucket(nanoseconds)].fetch_add(1u, std::memory_order_relaxed);
+    mCount.fetch_add(1u, std::memory_order_relaxed);
+    mSum.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    auto maximum = mMaximum.load(std::memory_order_relaxed);
+    while (nanoseconds > maximum && !mMaximum.compare_exchange_weak(maximum, nanoseconds, std::memory_order_relaxed))
+        ;
+}
+
+LatencyHistogram::Summary LatencyHistogram::collect()
+{
+    // Records racing with the collection land in this interval or the next one
+    uint64_t buckets[NUMBER_OF_BUCKETS];
+    uint64_t total = 0u;
+    for (size_t i = 0; i < NUMBER_OF_BUCKETS; ++i)
+    {
+        buckets[i] = mBuckets[i].exchange(0u, std::memory_order_relaxed);
+        total += buckets[i];
+    }
+
+    Summary summary = {};
+    summary.count = mCount.exchange(0u, std::memory_order_relaxed);
+    auto sum = mSum.exchange(0u, std::memory_order_relaxed);
+    summary.maximum = mMaximum.exchange(0u, std::memory_order_relaxed);
+    summary.mean = summary.count > 0u ? (double) sum / summary.count : 0.;
+
+    uint64_t seen = 0u;
+    auto p50Rank = (total + 1u) / 2u;
+    auto p99Rank = total - total / 100u;
+    for (size_t i = 0; i < NUMBER_OF_BUCKETS && seen < p99Rank; ++i)
+    {
+        seen += buckets[i];
+        if (summary.p50 == 0u && seen >= p50Rank && p50Rank > 0u)
+            summary.p50 = std::min(getUpperBound(i), summary.maximum);
+        if (seen >= p99Rank)
+            summary.p99 = std::min(getUpperBound(i), summary.maximum);
+    }
+    return summary;
+}
+
+size_t LatencyHistogram::getBucket(uint64_t nanoseconds)
+{
+    if (nanoseconds < 16u)
+        return (size_t) nanoseconds;
+
+    auto exponent = highestBit(nanoseconds);
+    auto subBucket = (nanoseconds >> (exponent - 3)) & (SUB_BUCKETS - 1u);
+    return 16u + (exponent - 4) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t LatencyHistogram::getUpperBound(size_t bucket)
+{
+    if (bucket < 16u)
+        return bucket;
+
+    auto exponent = (bucket - 16u) / SUB_BUCKETS + 4u;
+    auto subBucket = (bucket - 16u) % SUB_BUCKETS;
+    auto width = uint64_t(1) << (exponent - 3u);
+    return ((SUB_BUCKETS + subBucket) << (exponent - 3u)) + width - 1u;
+}
+
+
+Instrumentation::Instrumentation()
+: mHistograms()
+, mSummaries()
+, mIntervalStart(std::chrono::steady_clock::now())
+{
+    for (size_t i = 0; i < SV::NUMBER_OF_COUNTERS; ++i)
+    {
+        mCounters[i].store(0u, std::memory_order_relaxed);
+        mDumpedCounters[i] = 0u;
+    }
+}
+
+void Instrumentation::record(SV::Stage stage, std::chrono::steady_clock::duration duration)
+{
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    mHistograms[stage].record(nanoseconds > 0 ? (uint64_t) nanoseconds : 0u);
+}
+
+void Instrumentation::count(SV::Counter counter, uint64_t increment)
+{
+    mCounters[counter].fetch_add(increment, std::memory_order_relaxed);
+}
+
+void Instrumentation::dump(std::ostream& stream)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto seconds = std::chrono::duration<double>(now - mIntervalStart).count();
+    mIntervalStart = now;
+
+    auto flags = stream.flags();
+    auto precision = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+    stream << "Pipeline statistics over the last " << seconds << " s (milliseconds):" << std::endl;
+    stream << "  " << std::left << std::setw(16) << "Stage" << std::right << std::setw(10) << "count" << std::setw(10) << "mean"
+           << std::setw(10) << "p50" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    for (size_t i = 0; i < SV::NUMBER_OF_STAGES; ++i)
+    {
+        auto summary = mHistograms[i].collect();
+        mSummaries[i] = summary;
+        if (summary.count == 0u)
+            continue;
+        stream << "  " << std::left << std::setw(16) << STAGE_NAMES[i] << std::right << std::setw(10) << summary.count
+               << std::setw(10) << toMilliseconds((uint64_t) summary.mean) << std::setw(10) << toMilliseconds(summary.p50)
+               << std::setw(10) << toMilliseconds(summary.p99) << std::setw(10) << toMilliseconds(summary.maximum) << std::endl;
+    }
+
+    stream << std::setprecision(1);
+    for (size_t i = 0; i < SV::NUMBER_OF_COUNTERS; ++i)
+    {
+        auto total = mCounters[i].load(std::memory_order_relaxed);
+        auto interval = total - mDumpedCounters[i];
+        mDumpedCounters[i] = total;
+        stream << "  " << std::left << std::setw(26) << COUNTER_NAMES[i] << std::right << std::setw(10) << total
+               << " total, " << (seconds > 0. ? interval / seconds : 0.) << "/s" << std::endl;
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+}
+
+LatencyHistogram::Summary Instrumentation::getSummary(SV::Stage stage) const
+{
+    return mSummaries[stage];
+}
+
+const char* Instrumentation::getStageName(SV::Stage stage)
+{
+    return STAGE_NAMES[stage];
+}
+
+const char* Instrumentation::getCounterName(SV::Counter counter)
+{
+    return COUNTER_NAMES[counter];
+}
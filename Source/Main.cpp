@@ -1,9 +1,26 @@
 #include <SV/Application.hpp>
+#include <SV/DirectoryFrameSource.hpp>
+#include <SV/VideoFrameSource.hpp>
+#include <SV/SyntheticFrameSource.hpp>
+#include <SV/RecordingFrameSource.hpp>
+#ifdef SV_WITH_PYLON
+#include <SV/PylonFrameSource.hpp>
+#endif
 
+#include <memory>
+#include <string>
+#include <cstdio>
 #include <stdexcept>
 #include <cstdlib>
 #include <iostream>
 #include <unistd.h>
+#include <getopt.h>
+
+#ifdef SV_WITH_PYLON
+const std::string defaultFrameSource = "pylon";
+#else
+const std::string defaultFrameSource = "synthetic";
+#endif
 
 void usage()
 {
@@ -14,43 +31,138 @@ void usage()
     std::cerr << "-h H  :  [H]eight of chessboard corners (H >= 2 & H != W)" << std::endl;
     std::cerr << "-s S  :  [S]ize of chessboard square in centimeters (S >= 2.0)" << std::endl;
     std::cerr << "-d D  :  [D]elay after taking a calibration photo in seconds (3.0 <= D <= 60.0)" << std::endl;
+    std::cerr << "-f F  :  [F]rame source: pylon, directory, video, synthetic or recording (default: " << defaultFrameSource << ")" << std::endl;
+    std::cerr << "-r R  :  [R]ig pair to calibrate, in the order of Config/Rig/rig.xml (default: 0)" << std::endl;
+    std::cerr << "-p P  :  [P]ath of the frame source: images folder (directory), LEFT,RIGHT video files (video), WxH[,mono|bayer[,FPS]] (synthetic)" << std::endl;
+    std::cerr << "         or FILE[,realtime|fast[,FRAME]] (recording: replay pace, default realtime, and first frame)" << std::endl;
+    std::cerr << "-o O  :  Rec[o]rd the raw frames of the frame source to file O, without processing" << std::endl;
+    std::cerr << "--headless : no windows; capture runs until Ctrl+C or the end of the frame source" << std::endl;
+}
+
+std::unique_ptr<FrameSource> createFrameSource(const std::string& source, const std::string& path, const SV::CalibrationPattern& calibrationPattern)
+{
+    if (source == "directory")
+    {
+        return std::unique_ptr<FrameSource>(new DirectoryFrameSource(path.empty() ? SV::EMULATED_IMAGES_PATH : path, true));
+    }
+    else if (source == "video")
+    {
+        auto separator = path.find(',');
+        if (separator == std::string::npos)
+            throw std::runtime_error("createFrameSource() - Video source expects LEFT,RIGHT files");
+        return std::unique_ptr<FrameSource>(new VideoFrameSource(path.substr(0, separator), path.substr(separator + 1)));
+    }
+    else if (source == "synthetic")
+    {
+        // WxH[,mono|bayer[,FPS]]: a posed chessboard in front of a virtual rig, at the sensor's geometry by default
+        int width = 2590, height = 1942;
+        char pixelFormat[8] = "mono";
+        double frameRate = 0.;
+        if (!path.empty() && std::sscanf(path.c_str(), "%dx%d,%7[a-z],%lf", &width, &height, pixelFormat, &frameRate) < 2)
+            throw std::runtime_error("createFrameSource() - Synthetic source expects a WxH resolution");
+        if (std::string(pixelFormat) != "mono" && std::string(pixelFormat) != "bayer")
+            throw std::runtime_error("createFrameSource() - Synthetic source expects mono or bayer pixels");
+
+        SyntheticFrameSource::Parameters parameters(cv::Size(width, height), cv::Size(calibrationPattern.w, calibrationPattern.h), calibrationPattern.s);
+        parameters.pixelFormat = std::string(pixelFormat) == "bayer" ? SV::PIXEL_FORMAT_BAYERGB8 : SV::PIXEL_FORMAT_MONO8;
+        parameters.frameRate = frameRate;
+        return std::unique_ptr<FrameSource>(new SyntheticFrameSource(parameters));
+    }
+    else if (source == "recording")
+    {
+        // FILE[,realtime|fast[,FRAME]]
+        auto separator = path.find(',');
+        auto recordingFile = path.substr(0, separator);
+        auto replayMode = RecordingFrameSource::REPLAY_REAL_TIME;
+        uint64_t firstFrame = 0u;
+        if (separator != std::string::npos)
+        {
+            auto options = path.substr(separator + 1);
+            auto frameSeparator = options.find(',');
+            auto pace = options.substr(0, frameSeparator);
+            if (pace == "fast")
+                replayMode = RecordingFrameSource::REPLAY_FAST;
+            else if (pace != "realtime")
+                throw std::runtime_error("createFrameSource() - Recording source expects a realtime or fast replay");
+            if (frameSeparator != std::string::npos)
+                firstFrame = std::strtoull(options.c_str() + frameSeparator + 1, nullptr, 10);
+        }
+        if (recordingFile.empty())
+            throw std::runtime_error("createFrameSource() - Recording source expects a FILE");
+        return std::unique_ptr<FrameSource>(new RecordingFrameSource(recordingFile, replayMode, firstFrame));
+    }
+#ifdef SV_WITH_PYLON
+    else if (source == "pylon")
+    {
+        return std::unique_ptr<FrameSource>(new PylonFrameSource());
+    }
+#endif
+
+    throw std::runtime_error("createFrameSource() - Unknown or unavailable frame source: " + source);
 }
 
 int main(int argc, char** argv)
 {
 	int option;
-    unsigned int n = 20, w = 9, h = 6;
+    unsigned int n = 20, w = 9, h = 6, r = 0;
     float s = 2.3, d = 3.5;
-    bool c, defaultValues = false;
-
-    argc > 1 ? c = false : c = true;
+    bool c = true, defaultValues = false, headless = false;
+    std::string f(defaultFrameSource), p, o;
+    // Long options only; 'H' is not a short option
+    const struct option longOptions[] =
+    {
+        {"headless", no_argument, nullptr, 'H'},
+        {nullptr, 0, nullptr, 0}
+    };
 
     opterr = 0;
-    while ((option = getopt(argc, argv, "ucn:w:h:s:d:")) != -1)
+    while ((option = getopt_long(argc, argv, "ucn:w:h:s:d:f:p:r:o:", longOptions, nullptr)) != -1)
     {
         switch (option)
         {
             case 'u':
                 usage();
                 return 0;
+            // Any calibration option schedules a new calibration
             case 'c':
+                c = false;
                 defaultValues = true;
                 break;
             case 'n':
+                c = false;
                 n = (unsigned int) atoi(optarg);
                 break;
             case 'w':
+                c = false;
                 w = (unsigned int) atoi(optarg);
                 break;
             case 'h':
+                c = false;
                 h = (unsigned int) atoi(optarg);
                 break;
             case 's':
+                c = false;
                 s = atof(optarg);
                 break;
             case 'd':
+                c = false;
                 d = atof(optarg);
                 break;
+            case 'f':
+                f = optarg;
+                break;
+            case 'p':
+                p = optarg;
+                break;
+            case 'r':
+                r = (unsigned int) atoi(optarg);
+                break;
+            case 'o':
+                o = optarg;
+                break;
+            case 'H':
+                headless = true;
+                break;
             case '?':
                 usage();
                 return 1;
@@ -75,14 +187,22 @@ int main(int argc, char** argv)
 
     try
     {
-        Application::CalibrationParameters calibrationParameters(c, n, w, h, s, d);
+        Application::CalibrationParameters calibrationParameters(c, n, w, h, s, d, r);
         std::cout << "N = " << calibrationParameters.numberPhotos << std::endl;
         std::cout << "W = " << calibrationParameters.width << std::endl;
         std::cout << "H = " << calibrationParameters.height << std::endl;
         std::cout << "S = " << calibrationParameters.size << std::endl;
         std::cout << "D = " << calibrationParameters.delay << std::endl;
+        std::cout << "F = " << f << std::endl;
+        std::cout << "R = " << calibrationParameters.pair << std::endl;
+        if (!o.empty())
+            std::cout << "O = " << o << std::endl;
         std::cout << SV::lineBreak;
-        Application app(calibrationParameters);
+        // The synthetic chessboard must match the pattern used in capture
+        auto calibrationPattern = SV::loadCalibrationPatternFile();
+        if (!c || calibrationPattern.w == 0u)
+            calibrationPattern = SV::CalibrationPattern(w, h, s);
+        Application app(calibrationParameters, createFrameSource(f, p, calibrationPattern), headless, o);
         app.run();
     }
     catch (std::exception& e)
@@ -0,0 +1,164 @@
+#include <SV/Preprocessor.hpp>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+
+class Preprocessor::ConvertBody : public cv::ParallelLoopBody
+{
+    public:
+        ConvertBody(const cv::Mat& image, SV::PixelFormat pixelFormat, bool binning, cv::Mat& imageGray, std::vector<SV::Histogram>& histograms)
+        : mImage(image)
+        , mPixelFormat(pixelFormat)
+        , mBinning(binning)
+        , mImageGray(imageGray)
+        , mHistograms(histograms)
+        {
+        }
+
+        virtual void operator()(const cv::Range& range) const
+        {
+            auto rows = mImageGray.rows;
+            auto bands = (int) mHistograms.size();
+            for (int band = range.start; band < range.end; ++band)
+            {
+                // The histogram reads the band while it is still in cache
+                auto firstRow = rows * band / bands, lastRow = rows * (band + 1) / bands;
+                SV::convertToGrayRows(mImage, mPixelFormat, mImageGray, mBinning, firstRow, lastRow);
+                SV::countHistogramRows(mImageGray, mHistograms[band], firstRow, lastRow);
+            }
+        }
+
+    private:
+        const cv::Mat&              mImage;
+        SV::PixelFormat             mPixelFormat;
+        bool                        mBinning;
+        cv::Mat&                    mImageGray;
+        std::vector<SV::Histogram>& mHistograms;
+};
+
+
+class Preprocessor::BinarizeBody : public cv::ParallelLoopBody
+{
+    public:
+        BinarizeBody(const cv::Mat& imageGray, double threshold, cv::Mat& binaryImage, int bands)
+        : mImageGray(imageGray)
+        , mThreshold(threshold)
+        , mBinaryImage(binaryImage)
+        , mBands(bands)
+        {
+        }
+
+        virtual void operator()(const cv::Range& range) const
+        {
+            auto rows = mImageGray.rows;
+            cv::Range bandRows(rows * range.start / mBands, rows * range.end / mBands);
+            auto band = mBinaryImage.rowRange(bandRows);
+            cv::threshold(mImageGray.rowRange(bandRows), band, mThreshold, 255, CV_THRESH_BINARY);
+        }
+
+    private:
+        const cv::Mat&              mImageGray;
+        double                      mThreshold;
+        cv::Mat&                    mBinaryImage;
+        int                         mBands;
+};
+
+
+class Preprocessor::RectifyBody : public cv::ParallelLoopBody
+{
+    public:
+        // Without a binary image the bands binarize imageGray while they remap it
+        RectifyBody(const Rectifier& rectifier, const cv::Mat& imageGray, double threshold, const cv::Mat& binaryImage, cv::Mat& rectifiedImage, int bands)
+        : mRectifier(rectifier)
+        , mImageGray(imageGray)
+        , mThreshold(threshold)
+        , mBinaryImage(binaryImage)
+        , mRectifiedImage(rectifiedImage)
+        , mBands(bands)
+        {
+        }
+
+        virtual void operator()(const cv::Range& range) const
+        {
+            auto rows = mRectifiedImage.rows;
+            auto firstRow = rows * range.start / mBands, lastRow = rows * range.end / mBands;
+            if (mBinaryImage.empty())
+                mRectifier.rectifyThresholdedRows(mImageGray, mThreshold, mRectifiedImage, firstRow, lastRow);
+            else
+                mRectifier.rectifyRows(mBinaryImage, mRectifiedImage, firstRow, lastRow);
+        }
+
+    private:
+        const Rectifier&            mRectifier;
+        const cv::Mat&              mImageGray;
+        double                      mThreshold;
+        const cv::Mat&              mBinaryImage;
+        cv::Mat&                    mRectifiedImage;
+        int                         mBands;
+};
+
+
+Preprocessor::Preprocessor(const Rectifier* rectifierPtr, size_t bandSize)
+: mRectifierPtr(rectifierPtr)
+, mBandSize(bandSize)
+, mHistograms()
+{
+}
+
+void Preprocessor::convert(const cv::Mat& image, SV::PixelFormat pixelFormat, bool binning, cv::Mat& imageGray)
+{
+    if (pixelFormat == SV::PIXEL_FORMAT_MONO8)
+        imageGray = image;
+    else if (pixelFormat == SV::PIXEL_FORMAT_BAYERGB8 && (image.type() != CV_8UC1 || image.rows < 2 || image.cols < 2))
+        throw std::runtime_error("Preprocessor::convert() - Expected an 8-bit Bayer mosaic of at least 2x2 pixels");
+    else
+        imageGray.create(SV::getGraySize(image.size(), pixelFormat, binning), CV_8UC1);
+
+    auto bands = getBands(imageGray);
+    mHistograms.resize(bands);
+    cv::parallel_for_(cv::Range(0, bands), ConvertBody(image, pixelFormat, binning, imageGray, mHistograms), (double) bands);
+}
+
+double Preprocessor::threshold()
+{
+    SV::Histogram histogram;
+    histogram.fill(0u);
+    for (auto& bandHistogram : mHistograms)
+    {
+        for (size_t i = 0; i < histogram.size(); ++i)
+            histogram[i] += bandHistogram[i];
+    }
+
+    return SV::getOtsuThreshold(histogram);
+}
+
+void Preprocessor::rectify(const cv::Mat& imageGray, double threshold, cv::Mat& binaryImage, cv::Mat& rectifiedImage)
+{
+    rectifiedImage.create(mRectifierPtr->getSize(), CV_8UC1);
+
+    // Interpolating maps blend neighbouring pixels, so they must see the binary image, not the gray one
+    cv::Mat binary;
+    if (mRectifierPtr->getInterpolation() != cv::INTER_NEAREST)
+    {
+        binaryImage.create(imageGray.size(), CV_8UC1);
+        auto bands = getBands(imageGray);
+        cv::parallel_for_(cv::Range(0, bands), BinarizeBody(imageGray, threshold, binaryImage, bands), (double) bands);
+        binary = binaryImage;
+    }
+
+    auto bands = getBands(rectifiedImage);
+    cv::parallel_for_(cv::Range(0, bands), RectifyBody(*mRectifierPtr, imageGray, threshold, binary, rectifiedImage, bands), (double) bands);
+}
+
+int Preprocessor::getBands(const cv::Mat& image) const
+{
+    // bandSize 0 keeps the whole image in one band
+    if (mBandSize == 0u || image.rows == 0)
+        return 1;
+
+    auto rowsPerBand = std::max<size_t>(1u, mBandSize / std::max<size_t>(1u, image.cols * image.elemSize()));
+    return (int) ((image.rows + rowsPerBand - 1u) / rowsPerBand);
+}
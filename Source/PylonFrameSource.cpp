@@ -0,0 +1,175 @@
+#include <SV/PylonFrameSource.hpp>
+#include <SV/CameraConfiguration.hpp>
+#include <SV/Utility.hpp>
+
+#include <pylon/GrabResultPtr.h>
+#include <GenApi/INodeMap.h>
+#include <GenApi/Types.h>
+
+#include <memory>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+
+PylonFrameSource::PylonFrameSource()
+: mAutoInitTerm()
+, mTransportLayerFactory(Pylon::CTlFactory::GetInstance())
+, mDevices()
+, mCameras()
+, mEmulated(false)
+, mImageSizes()
+, mStreamParameters()
+{
+}
+
+void PylonFrameSource::open()
+{
+    attachDevices();
+    // Triggers Configuration Event (CameraConfiguration.cpp)
+    mCameras.Open();
+
+    // AOI and packet size loaded from the configuration file on OnOpened()
+    mImageSizes.clear();
+    mStreamParameters.clear();
+    for (size_t i = 0; i < getNumberOfCameras(); ++i)
+    {
+        GenApi::INodeMap& nodeMap = mCameras[i].GetNodeMap();
+        mImageSizes.push_back(cv::Size((int) GenApi::CIntegerPtr(nodeMap.GetNode("Width"))->GetValue(), (int) GenApi::CIntegerPtr(nodeMap.GetNode("Height"))->GetValue()));
+
+        SV::StreamParameters streamParameters;
+        streamParameters.imageSize = mImageSizes.back();
+        // Mono8 and BayerGB8 only (see retrieveFrame())
+        streamParameters.bitsPerPixel = 8;
+        streamParameters.packetSize = (int) GenApi::CIntegerPtr(nodeMap.GetNode("GevSCPSPacketSize"))->GetValue();
+        GenApi::CIntegerPtr tickFrequency(nodeMap.GetNode("GevTimestampTickFrequency"));
+        if (GenApi::IsReadable(tickFrequency))
+            streamParameters.tickFrequency = (double) tickFrequency->GetValue();
+        mStreamParameters.push_back(streamParameters);
+    }
+
+    if (!mEmulated && SV::BANDWIDTH_SCHEDULING)
+        scheduleTransportDelays();
+}
+
+void PylonFrameSource::close()
+{
+    mCameras.Close();
+}
+
+bool PylonFrameSource::isOpen() const
+{
+    return mCameras.IsOpen();
+}
+
+void PylonFrameSource::startGrabbing()
+{
+    // Cameras Synchronization: Round-Robin Strategy
+    mCameras.StartGrabbing(Pylon::GrabStrategy_UpcomingImage);
+}
+
+void PylonFrameSource::stopGrabbing()
+{
+    mCameras.StopGrabbing();
+}
+
+bool PylonFrameSource::isGrabbing() const
+{
+    return mCameras.IsGrabbing();
+}
+
+bool PylonFrameSource::retrieveFrame(SV::Frame& frame, unsigned int timeout)
+{
+    Pylon::CGrabResultPtr grabResultPtr;
+    if (!mCameras.RetrieveResult(timeout, grabResultPtr, Pylon::TimeoutHandling_Return))
+        return false;
+
+    if (!grabResultPtr->GrabSucceeded())
+    {
+        std::cout << getCameraName(grabResultPtr->GetCameraContext()) << " PylonFrameSource::retrieveFrame() ERROR: " << grabResultPtr->GetErrorCode() << " " << grabResultPtr->GetErrorDescription() << std::endl;
+        return false;
+    }
+
+    // OpenCV image CV_8U: 8-bits, 1 channel; the grab result owns the buffer
+    frame.image = cv::Mat(grabResultPtr->GetHeight(), grabResultPtr->GetWidth(), CV_8UC1, grabResultPtr->GetBuffer());
+    frame.camera = grabResultPtr->GetCameraContext();
+    frame.id = grabResultPtr->GetFrameNumber();
+    frame.timestamp = grabResultPtr->GetTimeStamp();
+    frame.pixelFormat = grabResultPtr->GetPixelType() == Pylon::PixelType_BayerGB8 ? SV::PIXEL_FORMAT_BAYERGB8 : SV::PIXEL_FORMAT_MONO8;
+    frame.owner = std::make_shared<Pylon::CGrabResultPtr>(grabResultPtr);
+
+    return true;
+}
+
+size_t PylonFrameSource::getNumberOfCameras() const
+{
+    return std::min(mDevices.size(), mCameras.GetSize());
+}
+
+cv::Size PylonFrameSource::getImageSize(size_t camera) const
+{
+    return camera < mImageSizes.size() ? mImageSizes[camera] : cv::Size();
+}
+
+bool PylonFrameSource::isEmulated() const
+{
+    return mEmulated;
+}
+
+bool PylonFrameSource::getStreamParameters(size_t camera, SV::StreamParameters& streamParameters) const
+{
+    if (mEmulated || camera >= mStreamParameters.size())
+        return false;
+
+    streamParameters = mStreamParameters[camera];
+    return true;
+}
+
+void PylonFrameSource::setTransportDelays(size_t camera, const SV::TransportDelays& transportDelays)
+{
+    if (!mEmulated && camera < getNumberOfCameras())
+        CameraConfiguration::setTransportDelays(mCameras[camera], transportDelays, getCameraName(camera));
+}
+
+void PylonFrameSource::attachDevices()
+{
+    if (mTransportLayerFactory.EnumerateDevices(mDevices) == 0)
+        throw std::runtime_error("PylonFrameSource::attachDevices() - No Camera Devices found");
+
+    // Every camera of the array must be attached before Open()
+    mCameras.Initialize(std::min(mDevices.size(), (size_t) SV::MAX_NUMBER_OF_CAMERAS));
+    for (size_t i = 0; i < mCameras.GetSize(); ++i)
+    {
+        std::string cameraModel;
+        // Attach device to Pylon's camera array
+        mCameras[i].Attach(mTransportLayerFactory.CreateDevice(mDevices[i]));
+        Pylon::CInstantCamera &camera = mCameras[i];
+        // Frame::camera of the grab results
+        camera.SetCameraContext(i);
+        cameraModel += camera.GetDeviceInfo().GetModelName();
+        // Register Camera's Configuration
+        if (cameraModel != SV::EMULATED_CAMERA)
+        {
+            camera.RegisterConfiguration
+            (
+                new CameraConfiguration(SV::CONFIGURATION_FILE, getCameraName(i)),
+                Pylon::RegistrationMode_ReplaceAll,
+                Pylon::Cleanup_Delete
+            );
+        }
+        else
+        {
+            mEmulated = true;
+        }
+    }
+}
+
+void PylonFrameSource::scheduleTransportDelays()
+{
+    // Link budget only: the processing time is unknown until the pipeline runs (Application re-tunes it)
+    BandwidthScheduler bandwidthScheduler(SV::GIGE_LINK_BANDWIDTH, SV::GIGE_SCHEDULE_MARGIN);
+    auto schedule = bandwidthScheduler.compute(mStreamParameters, 0.);
+    std::cout << SV::lineBreak << "Scheduled transport delays for " << 1. / schedule.framePeriod << " FPS per camera on the shared link" << std::endl;
+    for (size_t i = 0; i < schedule.delays.size(); ++i)
+        setTransportDelays(i, schedule.delays[i]);
+}
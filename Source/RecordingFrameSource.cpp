@@ -0,0 +1,218 @@
+#include <SV/RecordingFrameSource.hpp>
+
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace
+{
+    // Frames handed to the kernel read-ahead beyond the next one; about 40 MiB of 5 MP frames
+    const uint64_t PREFETCH_FRAMES = 8u;
+
+    bool isValid(const SV::RecordedFrame& recordedFrame, uint64_t mappingSize)
+    {
+        return recordedFrame.rows > 0 && recordedFrame.cols > 0 && recordedFrame.step >= recordedFrame.cols * CV_ELEM_SIZE(recordedFrame.type) &&
+            recordedFrame.offset % SV::RECORDING_ALIGNMENT == 0u && recordedFrame.offset + (uint64_t) recordedFrame.step * recordedFrame.rows <= mappingSize;
+    }
+}
+
+
+RecordingFrameSource::RecordingFrameSource(std::string recordingFile, ReplayMode replayMode, uint64_t firstFrame)
+: mRecordingFile(recordingFile)
+, mReplayMode(replayMode)
+, mFirstFrame(firstFrame)
+, mMapping()
+, mNumberOfCameras(0u)
+, mIndex()
+, mGrabbing(false)
+, mNextFrame(0u)
+, mPrefetched(0u)
+, mClockStarted(false)
+, mClockHostTime(0u)
+, mClockStart()
+{
+}
+
+void RecordingFrameSource::open()
+{
+    int fd = ::open(mRecordingFile.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("RecordingFrameSource::open() - Failed to open " + mRecordingFile);
+
+    struct stat fileStatus;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &fileStatus) == 0 && fileStatus.st_size >= (off_t) SV::RECORDING_ALIGNMENT)
+        mapping = mmap(nullptr, fileStatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("RecordingFrameSource::open() - Failed to map " + mRecordingFile);
+
+    uint64_t mappingSize = fileStatus.st_size;
+    mMapping = std::shared_ptr<unsigned char>(static_cast<unsigned char*>(mapping), [mappingSize](unsigned char* p) { munmap(p, mappingSize); });
+    // Replay reads front to back: the kernel reads ahead aggressively and reclaims the pages behind first
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+    auto header = reinterpret_cast<const SV::RecordingHeader*>(mMapping.get());
+    if (std::memcmp(header->magic, SV::RECORDING_MAGIC, sizeof(SV::RECORDING_MAGIC)) != 0 || header->version != SV::RECORDING_VERSION || header->cameras == 0u)
+    {
+        mMapping.reset();
+        throw std::runtime_error("RecordingFrameSource::open() - " + mRecordingFile + " is not a version " + std::to_string(SV::RECORDING_VERSION) + " recording");
+    }
+    mNumberOfCameras = header->cameras;
+
+    mIndex.clear();
+    if (header->indexOffset != 0u && header->indexOffset + header->frames * sizeof(SV::RecordedFrame) <= mappingSize)
+    {
+        auto index = reinterpret_cast<const SV::RecordedFrame*>(mMapping.get() + header->indexOffset);
+        mIndex.assign(index, index + header->frames);
+    }
+    else
+    {
+        std::cout << "RecordingFrameSource::open() - " << mRecordingFile << " was not closed, rebuilding its index" << std::endl;
+        scanChunks(mappingSize);
+    }
+
+    for (auto& recordedFrame : mIndex)
+    {
+        if (!isValid(recordedFrame, mappingSize) || recordedFrame.camera >= mNumberOfCameras)
+        {
+            mMapping.reset();
+            throw std::runtime_error("RecordingFrameSource::open() - " + mRecordingFile + " has a corrupted frame record");
+        }
+    }
+    std::cout << "Replaying " << mIndex.size() << " frames of " << mNumberOfCameras << " cameras from " << mRecordingFile << std::endl;
+
+    seek(mFirstFrame);
+}
+
+void RecordingFrameSource::close()
+{
+    mGrabbing = false;
+    // Frames still in the pipeline keep the mapping
+    mMapping.reset();
+}
+
+bool RecordingFrameSource::isOpen() const
+{
+    return mMapping != nullptr;
+}
+
+void RecordingFrameSource::startGrabbing()
+{
+    mGrabbing = isOpen();
+    mClockStarted = false;
+}
+
+void RecordingFrameSource::stopGrabbing()
+{
+    mGrabbing = false;
+}
+
+bool RecordingFrameSource::isGrabbing() const
+{
+    return mGrabbing && mNextFrame < mIndex.size();
+}
+
+bool RecordingFrameSource::retrieveFrame(SV::Frame& frame, unsigned int timeout)
+{
+    if (!isGrabbing())
+        return false;
+
+    auto& recordedFrame = mIndex[mNextFrame];
+    if (mReplayMode == REPLAY_REAL_TIME)
+    {
+        if (!mClockStarted)
+        {
+            mClockStarted = true;
+            mClockHostTime = recordedFrame.hostTime;
+            mClockStart = std::chrono::steady_clock::now();
+        }
+
+        auto hostTime = recordedFrame.hostTime > mClockHostTime ? recordedFrame.hostTime - mClockHostTime : 0u;
+        auto due = mClockStart + std::chrono::nanoseconds(hostTime);
+        if (due > std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            return false;
+        }
+        std::this_thread::sleep_until(due);
+    }
+
+    prefetch(mNextFrame);
+    frame.image = cv::Mat(recordedFrame.rows, recordedFrame.cols, recordedFrame.type, mMapping.get() + recordedFrame.offset, recordedFrame.step);
+    frame.camera = recordedFrame.camera;
+    frame.id = recordedFrame.id;
+    frame.timestamp = recordedFrame.timestamp;
+    frame.pixelFormat = static_cast<SV::PixelFormat>(recordedFrame.pixelFormat);
+    frame.owner = mMapping;
+    ++mNextFrame;
+
+    return true;
+}
+
+size_t RecordingFrameSource::getNumberOfCameras() const
+{
+    return mNumberOfCameras;
+}
+
+cv::Size RecordingFrameSource::getImageSize(size_t camera) const
+{
+    for (auto& recordedFrame : mIndex)
+    {
+        if (recordedFrame.camera == camera)
+            return cv::Size(recordedFrame.cols, recordedFrame.rows);
+    }
+    return cv::Size();
+}
+
+void RecordingFrameSource::seek(uint64_t frame)
+{
+    mNextFrame = std::min<uint64_t>(frame, mIndex.size());
+    mPrefetched = mNextFrame;
+    mClockStarted = false;
+}
+
+uint64_t RecordingFrameSource::getNumberOfFrames() const
+{
+    return mIndex.size();
+}
+
+void RecordingFrameSource::scanChunks(uint64_t mappingSize)
+{
+    // Stops at the first chunk the file does not hold entirely, the one being written when recording stopped
+    auto offset = SV::RECORDING_ALIGNMENT;
+    while (offset + SV::RECORDING_ALIGNMENT <= mappingSize)
+    {
+        auto chunkHeader = reinterpret_cast<const SV::RecordingChunkHeader*>(mMapping.get() + offset);
+        if (std::memcmp(chunkHeader->magic, SV::RECORDING_CHUNK_MAGIC, sizeof(SV::RECORDING_CHUNK_MAGIC)) != 0 || chunkHeader->frames > SV::RECORDING_CHUNK_FRAMES ||
+            chunkHeader->size < SV::RECORDING_ALIGNMENT || offset + chunkHeader->size > mappingSize)
+            break;
+
+        auto frames = reinterpret_cast<const SV::RecordedFrame*>(chunkHeader + 1);
+        mIndex.insert(mIndex.end(), frames, frames + chunkHeader->frames);
+        offset += chunkHeader->size;
+    }
+}
+
+void RecordingFrameSource::prefetch(uint64_t frame)
+{
+    // Ask for the frames ahead before the pipeline faults on them one page at a time
+    auto last = std::min<uint64_t>(frame + PREFETCH_FRAMES, mIndex.size());
+    if (mPrefetched >= last)
+        return;
+
+    static const uint64_t pageSize = (uint64_t) sysconf(_SC_PAGESIZE);
+    auto begin = mIndex[std::max(mPrefetched, frame)].offset / pageSize * pageSize;
+    auto& lastFrame = mIndex[last - 1u];
+    auto end = lastFrame.offset + (uint64_t) lastFrame.step * lastFrame.rows;
+    if (end > begin)
+        madvise(mMapping.get() + begin, end - begin, MADV_WILLNEED);
+    mPrefetched = last;
+}
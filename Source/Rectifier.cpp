@@ -0,0 +1,148 @@
+#include <SV/Rectifier.hpp>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+
+Rectifier::Rectifier(std::shared_ptr<const CalibrationBundle> calibrationBundle, size_t camera, SV::RemapMode remapMode, int interpolation)
+: mCalibrationBundle(calibrationBundle)
+, mRemapMode(remapMode)
+, mInterpolation(interpolation)
+, mMap1()
+, mMap2()
+{
+    std::string suffix(camera == 0 ? "1" : "2");
+
+    if (mRemapMode == SV::REMAP_FIXED_POINT_MAPS)
+    {
+        mMap1 = mCalibrationBundle->getMatrix(mInterpolation == cv::INTER_NEAREST ? "mxy" + suffix + "nn" : "mxy" + suffix);
+        mMap2 = mInterpolation == cv::INTER_NEAREST ? cv::Mat() : mCalibrationBundle->getMatrix("mtab" + suffix);
+        if (mMap1.empty() || (mInterpolation != cv::INTER_NEAREST && mMap2.empty()))
+        {
+            std::cout << "Rectifier::Rectifier() - Fixed-point maps not in calibration, using float maps" << std::endl;
+            mRemapMode = SV::REMAP_FLOAT_MAPS;
+        }
+    }
+
+    if (mRemapMode == SV::REMAP_FLOAT_MAPS)
+    {
+        mMap1 = mCalibrationBundle->getMatrix("mx" + suffix);
+        mMap2 = mCalibrationBundle->getMatrix("my" + suffix);
+    }
+
+    if (mMap1.empty())
+        throw std::runtime_error("Rectifier::Rectifier() - Rectification maps not in calibration");
+}
+
+void Rectifier::rectify(const cv::Mat& image, cv::Mat& rectifiedImage) const
+{
+    cv::remap(image, rectifiedImage, mMap1, mMap2, mInterpolation);
+}
+
+void Rectifier::rectifyRows(const cv::Mat& image, cv::Mat& rectifiedImage, int firstRow, int lastRow) const
+{
+    // cv::remap only reads the source pixels the map rows of the band point at
+    cv::Range rows(firstRow, lastRow);
+    auto band = rectifiedImage.rowRange(rows);
+    cv::remap(image, band, mMap1.rowRange(rows), mMap2.empty() ? cv::Mat() : mMap2.rowRange(rows), mInterpolation);
+}
+
+void Rectifier::rectifyThresholdedRows(const cv::Mat& image, double threshold, cv::Mat& rectifiedImage, int firstRow, int lastRow) const
+{
+    if (mInterpolation != cv::INTER_NEAREST)
+        throw std::runtime_error("Rectifier::rectifyThresholdedRows() - Interpolating maps must remap a binary image");
+
+    // cv::threshold(THRESH_BINARY) on 8-bit images compares against the floor of the threshold
+    unsigned char binary[256];
+    auto floor = cvFloor(threshold);
+    for (int i = 0; i < 256; ++i)
+        binary[i] = i > floor ? 255 : 0;
+
+    // Samples outside the image take the constant border of cv::remap, 0
+    const auto cols = (unsigned int) image.cols;
+    const auto rows = (unsigned int) image.rows;
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        auto rectified = rectifiedImage.ptr(y);
+        if (mMap1.type() == CV_16SC2)
+        {
+            auto xy = mMap1.ptr<short>(y);
+            for (int x = 0; x < rectifiedImage.cols; ++x)
+            {
+                auto sourceX = (unsigned int) xy[2 * x];
+                auto sourceY = (unsigned int) xy[2 * x + 1];
+                rectified[x] = sourceX < cols && sourceY < rows ? binary[image.ptr(sourceY)[sourceX]] : 0;
+            }
+        }
+        else
+        {
+            // Float maps round to the nearest pixel, as cv::remap does
+            auto mx = mMap1.ptr<float>(y);
+            auto my = mMap2.ptr<float>(y);
+            for (int x = 0; x < rectifiedImage.cols; ++x)
+            {
+                auto sourceX = (unsigned int) cvRound(mx[x]);
+                auto sourceY = (unsigned int) cvRound(my[x]);
+                rectified[x] = sourceX < cols && sourceY < rows ? binary[image.ptr(sourceY)[sourceX]] : 0;
+            }
+        }
+    }
+}
+
+cv::Size Rectifier::getSize() const
+{
+    return mMap1.size();
+}
+
+SV::RemapMode Rectifier::getRemapMode() const
+{
+    return mRemapMode;
+}
+
+int Rectifier::getInterpolation() const
+{
+    return mInterpolation;
+}
+
+std::vector<CalibrationBundle::NamedMatrix> Rectifier::createFixedPointMaps(const cv::Mat& mx, const cv::Mat& my, const std::string& suffix)
+{
+    cv::Mat mxy, mtab, mxynn, unused;
+    cv::convertMaps(mx, my, mxy, mtab, CV_16SC2, false);
+    cv::convertMaps(mx, my, mxynn, unused, CV_16SC2, true);
+
+    return
+    {
+        CalibrationBundle::NamedMatrix("mxy" + suffix, mxy),
+        CalibrationBundle::NamedMatrix("mtab" + suffix, mtab),
+        CalibrationBundle::NamedMatrix("mxy" + suffix + "nn", mxynn)
+    };
+}
+
+double Rectifier::measureFixedPointError(const cv::Mat& mx, const cv::Mat& my, const cv::Mat& mxy, const cv::Mat& mtab)
+{
+    const float scale = 1.f / cv::INTER_TAB_SIZE;
+    double maxError = 0.;
+
+    for (int row = 0; row < mx.rows; ++row)
+    {
+        auto x = mx.ptr<float>(row);
+        auto y = my.ptr<float>(row);
+        auto xy = mxy.ptr<short>(row);
+        auto tab = mtab.ptr<unsigned short>(row);
+        for (int col = 0; col < mx.cols; ++col)
+        {
+            // Coordinates outside the image only sample the border
+            if (x[col] < 0.f || y[col] < 0.f || x[col] >= mx.cols || y[col] >= mx.rows)
+                continue;
+            auto fixedX = xy[col * 2] + (tab[col] & (cv::INTER_TAB_SIZE - 1)) * scale;
+            auto fixedY = xy[col * 2 + 1] + (tab[col] >> cv::INTER_BITS) * scale;
+            maxError = std::max(maxError, (double) std::max(std::fabs(fixedX - x[col]), std::fabs(fixedY - y[col])));
+        }
+    }
+
+    return maxError;
+}
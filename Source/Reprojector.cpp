@@ -0,0 +1,174 @@
+#include <SV/Reprojector.hpp>
+#include <SV/DisparityEngine.hpp>
+
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+#if defined(__AVX__)
+    typedef __m256 Vector;
+    const int LANES = 8;
+    inline Vector load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+    inline Vector set(float value) { return _mm256_set1_ps(value); }
+    inline Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+#elif defined(__SSE2__)
+    typedef __m128 Vector;
+    const int LANES = 4;
+    inline Vector load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+    inline Vector set(float value) { return _mm_set1_ps(value); }
+    inline Vector multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+#endif
+
+    double coefficient(const cv::Mat& Q, int row, int col)
+    {
+        return Q.type() == CV_64FC1 ? Q.at<double>(row, col) : (double) Q.at<float>(row, col);
+    }
+}
+
+
+class Reprojector::BandBody : public cv::ParallelLoopBody
+{
+    public:
+        BandBody(const Reprojector& reprojector, const cv::Mat& disparity, SV::PointCloud& cloud, int bands)
+        : mReprojector(reprojector)
+        , mDisparity(disparity)
+        , mCloud(cloud)
+        , mBands(bands)
+        {
+        }
+
+        virtual void operator()(const cv::Range& range) const
+        {
+            auto rows = mDisparity.rows;
+            for (int band = range.start; band < range.end; ++band)
+                mReprojector.reprojectRows(mDisparity, mCloud, rows * band / mBands, rows * (band + 1) / mBands);
+        }
+
+    private:
+        const Reprojector&      mReprojector;
+        const cv::Mat&          mDisparity;
+        SV::PointCloud&         mCloud;
+        int                     mBands;
+};
+
+
+Reprojector::Reprojector(const cv::Mat& Q, int numberOfDisparities, int bands)
+: mBands(bands > 0 ? bands : (int) std::max(std::thread::hardware_concurrency(), 1u))
+, mInverseW()
+, mDepth()
+, mXScale(0.f)
+, mXOffset(0.f)
+, mYScale(0.f)
+, mYOffset(0.f)
+, mColumnX()
+{
+    if (Q.rows != 4 || Q.cols != 4 || (Q.type() != CV_64FC1 && Q.type() != CV_32FC1))
+        throw std::runtime_error("Reprojector::Reprojector() - Expected a 4x4 floating point reprojection matrix");
+    if (numberOfDisparities <= 0)
+        throw std::runtime_error("Reprojector::Reprojector() - Number of disparities must be positive");
+
+    // The tables rely on the layout of stereoRectify's Q
+    for (auto entry : {std::make_pair(0, 1), std::make_pair(0, 2), std::make_pair(1, 0), std::make_pair(1, 2),
+                       std::make_pair(2, 0), std::make_pair(2, 1), std::make_pair(2, 2), std::make_pair(3, 0), std::make_pair(3, 1)})
+    {
+        if (coefficient(Q, entry.first, entry.second) != 0.)
+            throw std::runtime_error("Reprojector::Reprojector() - Q does not have the layout of stereoRectify");
+    }
+
+    mXScale = (float) coefficient(Q, 0, 0);
+    mXOffset = (float) coefficient(Q, 0, 3);
+    mYScale = (float) coefficient(Q, 1, 1);
+    mYOffset = (float) coefficient(Q, 1, 3);
+
+    // One entry per fixed-point disparity below numberOfDisparities, plus the invalid entry
+    auto entries = (size_t) numberOfDisparities * DisparityEngine::DISPARITY_SCALE;
+    auto invalid = std::numeric_limits<float>::quiet_NaN();
+    mInverseW.assign(entries + 1u, invalid);
+    mDepth.assign(entries + 1u, invalid);
+    for (size_t value = 1; value < entries; ++value)
+    {
+        auto d = (double) value / DisparityEngine::DISPARITY_SCALE;
+        auto W = coefficient(Q, 3, 2) * d + coefficient(Q, 3, 3);
+        if (W == 0.)
+            continue;
+        mInverseW[value] = (float) (1. / W);
+        mDepth[value] = (float) (coefficient(Q, 2, 3) / W);
+    }
+}
+
+void Reprojector::reproject(const cv::Mat& disparity, SV::PointCloud& cloud)
+{
+    if (disparity.type() != CV_16SC1)
+        throw std::runtime_error("Reprojector::reproject() - Expected a CV_16SC1 disparity map");
+
+    cloud.x.create(disparity.size(), CV_32FC1);
+    cloud.y.create(disparity.size(), CV_32FC1);
+    cloud.z.create(disparity.size(), CV_32FC1);
+
+    if (mColumnX.size() != (size_t) disparity.cols)
+    {
+        mColumnX.resize(disparity.cols);
+        for (int x = 0; x < disparity.cols; ++x)
+            mColumnX[x] = mXScale * x + mXOffset;
+    }
+
+    auto bands = std::max(1, std::min(mBands, disparity.rows));
+    cv::parallel_for_(cv::Range(0, bands), BandBody(*this, disparity, cloud, bands), (double) bands);
+}
+
+void Reprojector::reprojectRows(const cv::Mat& disparity, SV::PointCloud& cloud, int firstRow, int lastRow) const
+{
+    const int width = disparity.cols;
+    const auto invalid = (unsigned int) (mInverseW.size() - 1u);
+    auto inverseW = mInverseW.data();
+    auto depth = mDepth.data();
+    auto columnX = mColumnX.data();
+
+    for (int y = firstRow; y < lastRow; ++y)
+    {
+        auto values = disparity.ptr<int16_t>(y);
+        auto X = cloud.x.ptr<float>(y);
+        auto Y = cloud.y.ptr<float>(y);
+        auto Z = cloud.z.ptr<float>(y);
+
+        // Table lookups; negative disparities wrap to large unsigned values and clamp to the invalid entry too
+        for (int x = 0; x < width; ++x)
+        {
+            auto index = std::min((unsigned int) (uint16_t) values[x], invalid);
+            X[x] = inverseW[index];
+            Z[x] = depth[index];
+        }
+
+        // X still holds 1/W here
+        auto rowY = mYScale * y + mYOffset;
+        int x = 0;
+#if defined(__AVX__) || defined(__SSE2__)
+        auto rowYs = set(rowY);
+        for (; x + LANES <= width; x += LANES)
+        {
+            auto w = load(X + x);
+            store(Y + x, multiply(w, rowYs));
+            store(X + x, multiply(w, load(columnX + x)));
+        }
+#endif
+        for (; x < width; ++x)
+        {
+            auto w = X[x];
+            Y[x] = w * rowY;
+            X[x] = w * columnX[x];
+        }
+    }
+}
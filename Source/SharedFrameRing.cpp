@@ -0,0 +1,295 @@
+#include <SV/SharedFrameRing.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace
+{
+    const char MAGIC[8] = {'S', 'V', 'R', 'I', 'N', 'G', '\0', '\0'};
+    const uint32_t VERSION = 1u;
+    const size_t ALIGNMENT = 64u;
+
+    size_t alignUp(size_t value)
+    {
+        return (value + ALIGNMENT - 1u) / ALIGNMENT * ALIGNMENT;
+    }
+
+    struct Header
+    {
+        // Written last, so a reader never sees a half initialised header
+        char                    magic[8];
+        uint32_t                version;
+        uint32_t                slots;
+        int32_t                 rows;
+        int32_t                 cols;
+        int32_t                 type;
+        uint32_t                reserved;
+        uint64_t                imageStep;
+        uint64_t                slotSize;
+        alignas(64) std::atomic<uint64_t>   published;
+    };
+
+    struct alignas(64) SlotHeader
+    {
+        std::atomic<uint64_t>   sequence;
+        uint64_t                id;
+        uint64_t                timestamp;
+        uint64_t                calibrationVersion;
+    };
+
+    const size_t HEADER_SIZE = alignUp(sizeof(Header));
+
+    Header* getHeader(unsigned char* mapping)
+    {
+        return reinterpret_cast<Header*>(mapping);
+    }
+
+    SlotHeader* getSlot(unsigned char* mapping, uint64_t sequence)
+    {
+        auto header = getHeader(mapping);
+        return reinterpret_cast<SlotHeader*>(mapping + HEADER_SIZE + (sequence % header->slots) * header->slotSize);
+    }
+
+    unsigned char* getImage(SlotHeader* slot, size_t camera, size_t imageSize)
+    {
+        return reinterpret_cast<unsigned char*>(slot) + sizeof(SlotHeader) + camera * imageSize;
+    }
+}
+
+
+SharedFrameWriter::SharedFrameWriter(const std::string& name, size_t slots, uint64_t calibrationVersion)
+: mName(name)
+, mSlots(slots)
+, mCalibrationVersion(calibrationVersion)
+, mMapping(nullptr)
+, mMappingSize(0u)
+, mPublished(0u)
+, mRejected(0u)
+{
+    // A reader must be able to hold one slot while the writer fills another
+    if (mSlots < 2u)
+        throw std::runtime_error("SharedFrameWriter::SharedFrameWriter() - Expected at least two slots");
+}
+
+SharedFrameWriter::~SharedFrameWriter()
+{
+    if (mMapping != nullptr)
+    {
+        munmap(mMapping, mMappingSize);
+        shm_unlink(mName.c_str());
+    }
+}
+
+void SharedFrameWriter::publish(const SV::Frame& left, const SV::Frame& right)
+{
+    auto& leftImage = left.image;
+    auto& rightImage = right.image;
+    if (mMapping == nullptr && !leftImage.empty())
+        create(leftImage.size(), leftImage.type());
+
+    auto header = mMapping != nullptr ? getHeader(mMapping) : nullptr;
+    if (header == nullptr || leftImage.rows != header->rows || leftImage.cols != header->cols || leftImage.type() != header->type ||
+        rightImage.size() != leftImage.size() || rightImage.type() != leftImage.type())
+    {
+        ++mRejected;
+        return;
+    }
+
+    auto sequence = mPublished;
+    auto slot = getSlot(mMapping, sequence);
+    slot->sequence.store(2u * sequence + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->id = left.id;
+    slot->timestamp = left.timestamp;
+    slot->calibrationVersion = mCalibrationVersion;
+    auto rowSize = (size_t) leftImage.cols * leftImage.elemSize();
+    auto imageSize = header->imageStep * header->rows;
+    for (size_t camera = 0; camera < 2u; ++camera)
+    {
+        auto& image = camera == 0u ? leftImage : rightImage;
+        auto data = getImage(slot, camera, imageSize);
+        for (int row = 0; row < image.rows; ++row)
+            std::memcpy(data + row * header->imageStep, image.ptr(row), rowSize);
+    }
+
+    slot->sequence.store(2u * sequence + 2u, std::memory_order_release);
+    mPublished = sequence + 1u;
+    header->published.store(mPublished, std::memory_order_release);
+}
+
+uint64_t SharedFrameWriter::getPublished() const
+{
+    return mPublished;
+}
+
+uint64_t SharedFrameWriter::getRejected() const
+{
+    return mRejected;
+}
+
+void SharedFrameWriter::create(cv::Size imageSize, int type)
+{
+    auto imageStep = alignUp((size_t) imageSize.width * CV_ELEM_SIZE(type));
+    auto slotSize = alignUp(sizeof(SlotHeader) + 2u * imageStep * imageSize.height);
+    auto mappingSize = HEADER_SIZE + mSlots * slotSize;
+
+    // Readers of a previous run keep their old mapping; new readers get the new ring
+    shm_unlink(mName.c_str());
+    int fd = shm_open(mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1)
+        throw std::runtime_error("SharedFrameWriter::create() - Failed to create shared memory " + mName);
+
+    void* mapping = MAP_FAILED;
+    if (ftruncate(fd, (off_t) mappingSize) == 0)
+        mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        shm_unlink(mName.c_str());
+        throw std::runtime_error("SharedFrameWriter::create() - Failed to map shared memory " + mName);
+    }
+
+    // ftruncate zero-fills, so every slot starts at sequence 0: no pair yet
+    mMapping = static_cast<unsigned char*>(mapping);
+    mMappingSize = mappingSize;
+    auto header = getHeader(mMapping);
+    header->version = VERSION;
+    header->slots = (uint32_t) mSlots;
+    header->rows = imageSize.height;
+    header->cols = imageSize.width;
+    header->type = type;
+    header->imageStep = imageStep;
+    header->slotSize = slotSize;
+    header->published.store(0u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+
+    std::cout << "Publishing rectified frames to shared memory " << mName << " (" << mSlots << " slots, "
+              << mappingSize / (1024u * 1024u) << " MiB)." << std::endl;
+}
+
+
+SharedFrameReader::SharedFrameReader(const std::string& name)
+: mMapping(nullptr)
+, mMappingSize(0u)
+, mNext(0u)
+, mDropped(0u)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1)
+        throw std::runtime_error("SharedFrameReader::SharedFrameReader() - No shared memory " + name);
+
+    struct stat status;
+    void* mapping = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size >= (off_t) HEADER_SIZE)
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        throw std::runtime_error("SharedFrameReader::SharedFrameReader() - Failed to map shared memory " + name);
+
+    mMapping = static_cast<unsigned char*>(mapping);
+    mMappingSize = status.st_size;
+    auto header = getHeader(mMapping);
+    bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!valid || header->version != VERSION || header->slots < 2u || HEADER_SIZE + header->slots * header->slotSize > mMappingSize)
+    {
+        munmap(mMapping, mMappingSize);
+        throw std::runtime_error("SharedFrameReader::SharedFrameReader() - " + name + " is not a ready frame ring");
+    }
+}
+
+SharedFrameReader::~SharedFrameReader()
+{
+    munmap(mMapping, mMappingSize);
+}
+
+bool SharedFrameReader::readNext(SV::SharedFrame& frame)
+{
+    auto header = getHeader(mMapping);
+    while (true)
+    {
+        auto published = header->published.load(std::memory_order_acquire);
+        if (mNext >= published)
+            return false;
+
+        // The slot after the newest pair may be half written already
+        auto oldest = published > header->slots - 1u ? published - (header->slots - 1u) : 0u;
+        if (mNext < oldest)
+        {
+            mDropped += oldest - mNext;
+            mNext = oldest;
+        }
+
+        auto sequence = mNext++;
+        if (read(sequence, frame))
+            return true;
+        ++mDropped;
+    }
+}
+
+bool SharedFrameReader::readLatest(SV::SharedFrame& frame)
+{
+    auto header = getHeader(mMapping);
+    while (true)
+    {
+        auto published = header->published.load(std::memory_order_acquire);
+        if (mNext >= published)
+            return false;
+
+        auto sequence = published - 1u;
+        mDropped += sequence - mNext;
+        mNext = sequence + 1u;
+        if (read(sequence, frame))
+            return true;
+        ++mDropped;
+    }
+}
+
+uint64_t SharedFrameReader::getDropped() const
+{
+    return mDropped;
+}
+
+cv::Size SharedFrameReader::getImageSize() const
+{
+    auto header = getHeader(mMapping);
+    return cv::Size(header->cols, header->rows);
+}
+
+bool SharedFrameReader::read(uint64_t sequence, SV::SharedFrame& frame)
+{
+    auto header = getHeader(mMapping);
+    auto slot = getSlot(mMapping, sequence);
+    auto expected = 2u * sequence + 2u;
+    if (slot->sequence.load(std::memory_order_acquire) != expected)
+        return false;
+
+    frame.left.create(header->rows, header->cols, header->type);
+    frame.right.create(header->rows, header->cols, header->type);
+    frame.id = slot->id;
+    frame.timestamp = slot->timestamp;
+    frame.calibrationVersion = slot->calibrationVersion;
+    frame.sequence = sequence;
+    auto rowSize = (size_t) header->cols * frame.left.elemSize();
+    auto imageSize = header->imageStep * header->rows;
+    for (size_t camera = 0; camera < 2u; ++camera)
+    {
+        auto& image = camera == 0u ? frame.left : frame.right;
+        auto data = getImage(slot, camera, imageSize);
+        for (int row = 0; row < image.rows; ++row)
+            std::memcpy(image.ptr(row), data + row * header->imageStep, rowSize);
+    }
+
+    // The copy only counts if the writer did not start on this slot meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == expected;
+}
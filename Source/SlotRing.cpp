@@ -0,0 +1,95 @@
+#include <SV/SlotRing.hpp>
+
+#include <new>
+
+
+// Hands out the storage of one slot; deallocation is the last thing done to a control block, so that is where the
+// slot goes back to the ring: it cannot be lent again while its previous owner is still being torn down
+template <typename T>
+class SlotRing::OwnerAllocator
+{
+    public:
+        typedef T value_type;
+
+        OwnerAllocator(SlotRing* slotRingPtr, size_t slot)
+        : mSlotRingPtr(slotRingPtr)
+        , mSlot(slot)
+        {
+        }
+
+        template <typename U>
+        OwnerAllocator(const OwnerAllocator<U>& other)
+        : mSlotRingPtr(other.mSlotRingPtr)
+        , mSlot(other.mSlot)
+        {
+        }
+
+        T* allocate(size_t n)
+        {
+            if (n * sizeof(T) > sizeof(OwnerStorage))
+                throw std::bad_alloc();
+            return reinterpret_cast<T*>(mSlotRingPtr->mOwnerStorage[mSlot].bytes);
+        }
+
+        void deallocate(T*, size_t)
+        {
+            mSlotRingPtr->release(mSlot);
+        }
+
+        template <typename U>
+        bool operator==(const OwnerAllocator<U>& other) const
+        {
+            return mSlotRingPtr == other.mSlotRingPtr && mSlot == other.mSlot;
+        }
+
+        template <typename U>
+        bool operator!=(const OwnerAllocator<U>& other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        template <typename U>
+        friend class OwnerAllocator;
+
+        SlotRing*       mSlotRingPtr;
+        size_t          mSlot;
+};
+
+
+SlotRing::SlotRing(size_t slots)
+: mSlots(slots)
+, mOwnerStorage(new OwnerStorage[slots])
+, mFreeSlots(slots)
+, mFreeSlotCount(0u)
+{
+    for (size_t i = 0; i < mSlots; ++i)
+        release(i);
+}
+
+bool SlotRing::tryAcquire(size_t& slot, std::shared_ptr<void>& owner)
+{
+    if (!mFreeSlots.tryPop(slot))
+        return false;
+
+    --mFreeSlotCount;
+    // The owner points at the ring but deletes nothing; only its control block matters
+    owner = std::shared_ptr<void>(this, [](void*) {}, OwnerAllocator<char>(this, slot));
+    return true;
+}
+
+size_t SlotRing::getSlots() const
+{
+    return mSlots;
+}
+
+size_t SlotRing::getFreeSlots() const
+{
+    return mFreeSlotCount;
+}
+
+void SlotRing::release(size_t slot)
+{
+    mFreeSlots.tryPush(std::move(slot));
+    ++mFreeSlotCount;
+}
@@ -0,0 +1,241 @@
+#include <SV/StereoCalibrator.hpp>
+#include <SV/Rectifier.hpp>
+
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+    const char* STEP_NAMES[] = {"Calibrating", "Checking", "Rectifying", "Mapping", "Saving", "Done"};
+
+    // Matrices also written as XML files; the maps only go to the binary bundle, as text they take longer than the calibration
+    const char* XML_MATRICES[] = {"M1", "D1", "R1", "P1", "M2", "D2", "R2", "P2", "Q"};
+}
+
+
+StereoCalibrator::StereoCalibrator(cv::Size patternSize, float squareSize)
+: mPatternSize(patternSize)
+, mSquareSize(squareSize)
+, mImageSize()
+, mCornersLeft()
+, mCornersRight()
+, mState(STATE_COLLECTING)
+, mStep(STEP_CALIBRATING)
+, mCancelled(false)
+, mThread()
+, mCalibrationBundle()
+, mReport()
+{
+}
+
+StereoCalibrator::~StereoCalibrator()
+{
+    cancel();
+    wait();
+}
+
+bool StereoCalibrator::addView(cv::Size imageSize, const std::vector<cv::Point2f>& cornersLeft, const std::vector<cv::Point2f>& cornersRight)
+{
+    if (!isCollecting() || (size_t) mPatternSize.area() != cornersLeft.size() || cornersLeft.size() != cornersRight.size())
+        return false;
+    if (!mCornersLeft.empty() && imageSize != mImageSize)
+        throw std::runtime_error("StereoCalibrator::addView() - Image size changed between views");
+
+    mImageSize = imageSize;
+    mCornersLeft.push_back(cornersLeft);
+    mCornersRight.push_back(cornersRight);
+    return true;
+}
+
+size_t StereoCalibrator::getNumberOfViews() const
+{
+    return mCornersLeft.size();
+}
+
+void StereoCalibrator::start(const std::string& xmlFilesPath)
+{
+    if (!isCollecting())
+        throw std::runtime_error("StereoCalibrator::start() - Calibration already started");
+    if (mCornersLeft.empty())
+        throw std::runtime_error("StereoCalibrator::start() - No views to calibrate with");
+
+    mState = STATE_RUNNING;
+    mThread = std::thread(&StereoCalibrator::run, this, xmlFilesPath);
+}
+
+void StereoCalibrator::cancel()
+{
+    mCancelled = true;
+}
+
+void StereoCalibrator::wait()
+{
+    if (mThread.joinable())
+        mThread.join();
+}
+
+StereoCalibrator::State StereoCalibrator::getState() const
+{
+    return (State) mState.load();
+}
+
+bool StereoCalibrator::isCollecting() const
+{
+    return getState() == STATE_COLLECTING;
+}
+
+bool StereoCalibrator::isFinished() const
+{
+    auto state = getState();
+    return state == STATE_SUCCEEDED || state == STATE_FAILED || state == STATE_CANCELLED;
+}
+
+StereoCalibrator::Step StereoCalibrator::getStep() const
+{
+    return (Step) mStep.load();
+}
+
+float StereoCalibrator::getProgress() const
+{
+    return (float) getStep() / STEP_DONE;
+}
+
+std::string StereoCalibrator::getStepName(Step step)
+{
+    return STEP_NAMES[step];
+}
+
+std::shared_ptr<const CalibrationBundle> StereoCalibrator::getCalibrationBundle() const
+{
+    return getState() == STATE_SUCCEEDED ? mCalibrationBundle : std::shared_ptr<const CalibrationBundle>();
+}
+
+StereoCalibrator::Report StereoCalibrator::getReport() const
+{
+    return mReport;
+}
+
+void StereoCalibrator::run(std::string xmlFilesPath)
+{
+    try
+    {
+        if (!advance(STEP_CALIBRATING))
+            return;
+
+        auto views = mCornersLeft.size();
+        mReport = Report();
+        mReport.views = views;
+        mReport.imageSize = mImageSize;
+
+        // Same board coordinates as the StereoCalibration module
+        std::vector<cv::Point3f> boardCorners;
+        for (int i = 0; i < mPatternSize.height; ++i)
+            for (int j = 0; j < mPatternSize.width; ++j)
+                boardCorners.push_back(cv::Point3f(i * mSquareSize, j * mSquareSize, 0.f));
+        std::vector<std::vector<cv::Point3f>> objectPoints(views, boardCorners);
+
+        cv::Mat M1 = cv::Mat::eye(3, 3, CV_64F), M2 = cv::Mat::eye(3, 3, CV_64F);
+        cv::Mat D1 = cv::Mat::zeros(1, 5, CV_64F), D2 = cv::Mat::zeros(1, 5, CV_64F);
+        cv::Mat R, T, E, F;
+        mReport.reprojectionError = cv::stereoCalibrate(objectPoints, mCornersLeft, mCornersRight, M1, D1, M2, D2, mImageSize, R, T, E, F,
+            cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 100, 1e-5),
+            cv::CALIB_FIX_ASPECT_RATIO + cv::CALIB_ZERO_TANGENT_DIST + cv::CALIB_SAME_FOCAL_LENGTH);
+        if (!advance(STEP_CHECKING))
+            return;
+
+        // The fundamental matrix holds everything; check m2^t * F * m1 = 0 in undistorted space
+        double epipolarError = 0.;
+        for (size_t i = 0; i < views; ++i)
+        {
+            std::vector<cv::Point2f> points1, points2;
+            std::vector<cv::Vec3f> lines1, lines2;
+            cv::undistortPoints(mCornersLeft[i], points1, M1, D1, cv::Mat(), M1);
+            cv::undistortPoints(mCornersRight[i], points2, M2, D2, cv::Mat(), M2);
+            cv::computeCorrespondEpilines(points1, 1, F, lines1);
+            cv::computeCorrespondEpilines(points2, 2, F, lines2);
+            for (size_t j = 0; j < points1.size(); ++j)
+            {
+                epipolarError += std::fabs(points1[j].x * lines2[j][0] + points1[j].y * lines2[j][1] + lines2[j][2])
+                    + std::fabs(points2[j].x * lines1[j][0] + points2[j].y * lines1[j][1] + lines1[j][2]);
+            }
+        }
+        mReport.epipolarError = epipolarError / (views * mPatternSize.area());
+        if (!advance(STEP_RECTIFYING))
+            return;
+
+        cv::Mat R1, R2, P1, P2, Q;
+        cv::stereoRectify(M1, D1, M2, D2, mImageSize, R, T, R1, R2, P1, P2, Q, 0);
+        if (!advance(STEP_MAPPING))
+            return;
+
+        cv::Mat mx1, my1, mx2, my2;
+        cv::initUndistortRectifyMap(M1, D1, R1, P1, mImageSize, CV_32FC1, mx1, my1);
+        cv::initUndistortRectifyMap(M2, D2, R2, P2, mImageSize, CV_32FC1, mx2, my2);
+        std::vector<CalibrationBundle::NamedMatrix> matrices
+        {
+            CalibrationBundle::NamedMatrix("M1", M1),
+            CalibrationBundle::NamedMatrix("D1", D1),
+            CalibrationBundle::NamedMatrix("R1", R1),
+            CalibrationBundle::NamedMatrix("P1", P1),
+            CalibrationBundle::NamedMatrix("M2", M2),
+            CalibrationBundle::NamedMatrix("D2", D2),
+            CalibrationBundle::NamedMatrix("R2", R2),
+            CalibrationBundle::NamedMatrix("P2", P2),
+            CalibrationBundle::NamedMatrix("Q", Q),
+            CalibrationBundle::NamedMatrix("mx1", mx1),
+            CalibrationBundle::NamedMatrix("my1", my1),
+            CalibrationBundle::NamedMatrix("mx2", mx2),
+            CalibrationBundle::NamedMatrix("my2", my2)
+        };
+        auto fixedPointMaps1 = Rectifier::createFixedPointMaps(mx1, my1, "1");
+        auto fixedPointMaps2 = Rectifier::createFixedPointMaps(mx2, my2, "2");
+        mReport.fixedPointError = std::max(
+            Rectifier::measureFixedPointError(mx1, my1, fixedPointMaps1[0].second, fixedPointMaps1[1].second),
+            Rectifier::measureFixedPointError(mx2, my2, fixedPointMaps2[0].second, fixedPointMaps2[1].second));
+        matrices.insert(matrices.end(), fixedPointMaps1.begin(), fixedPointMaps1.end());
+        matrices.insert(matrices.end(), fixedPointMaps2.begin(), fixedPointMaps2.end());
+        if (!advance(STEP_SAVING))
+            return;
+
+        if (!xmlFilesPath.empty())
+        {
+            for (auto name : XML_MATRICES)
+            {
+                cv::FileStorage fs(xmlFilesPath + name + ".xml", cv::FileStorage::WRITE);
+                if (!fs.isOpened())
+                    throw std::runtime_error("StereoCalibrator::run() - Failed to write " + xmlFilesPath + name + ".xml");
+                for (auto& matrix : matrices)
+                    if (matrix.first == name)
+                        fs << name << matrix.second;
+            }
+            CalibrationBundle::saveBinaryFile(xmlFilesPath + CalibrationBundle::FILE_NAME, matrices);
+        }
+
+        mCalibrationBundle = CalibrationBundle::createFromMatrices(matrices);
+        mStep = STEP_DONE;
+        mState = STATE_SUCCEEDED;
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+        mState = STATE_FAILED;
+    }
+}
+
+bool StereoCalibrator::advance(Step step)
+{
+    if (mCancelled)
+    {
+        mState = STATE_CANCELLED;
+        return false;
+    }
+
+    mStep = step;
+    return true;
+}
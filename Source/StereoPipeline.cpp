@@ -0,0 +1,509 @@
+#include <SV/StereoPipeline.hpp>
+#include <SV/Utility.hpp>
+#include <SV/ImageProcessing.hpp>
+#include <SV/Triangulation.hpp>
+
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+#include <iostream>
+#include <stdexcept>
+
+
+namespace
+{
+    // Display Buffers
+    const size_t LEFT_DISPLAY_BUFFER        = 0;
+    const size_t RIGHT_DISPLAY_BUFFER       = 1;
+    const size_t LEFT_DISPLAY_HALF_BUFFER   = 2;
+    const size_t RIGHT_DISPLAY_HALF_BUFFER  = 3;
+    const size_t DISPARITY_DISPLAY_BUFFER   = 4;
+    const size_t DISPARITY_DISPLAY_HALF_BUFFER = 5;
+
+    const std::string DISPARITY_WINDOW      = "Disparity";
+
+    // Disparity slot buffers: the disparity map, then the X, Y and Z planes of its point cloud
+    const size_t DISPARITY_SLOT_BUFFERS     = 4;
+
+    // Spin, then yield, then sleep: low latency while frames flow, no busy core while a stage is idle
+    class Backoff
+    {
+        public:
+            Backoff()
+            : mCount(0u)
+            {
+            }
+
+            void wait()
+            {
+                if (mCount < 64u)
+                {
+                    ++mCount;
+                    std::this_thread::yield();
+                }
+                else
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+
+        private:
+            unsigned int mCount;
+    };
+
+    template <typename Queue, typename T>
+    bool popWait(Queue& queue, T& value, const std::atomic<bool>& running)
+    {
+        Backoff backoff;
+        while (!queue.tryPop(value))
+        {
+            if (!running.load(std::memory_order_acquire))
+                return false;
+            backoff.wait();
+        }
+        return true;
+    }
+
+    template <typename Queue, typename T>
+    bool pushWait(Queue& queue, T&& value, const std::atomic<bool>& running)
+    {
+        Backoff backoff;
+        while (!queue.tryPush(std::move(value)))
+        {
+            if (!running.load(std::memory_order_acquire))
+                return false;
+            backoff.wait();
+        }
+        return true;
+    }
+
+    template <typename Queue, typename T>
+    void drain(Queue& queue)
+    {
+        T value;
+        while (queue.tryPop(value))
+            ;
+    }
+}
+
+
+StereoPipeline::StereoPipeline(std::string name, std::vector<std::string> cameraNames, cv::Size patternSize, cv::Mat Q, unsigned int detectWorkers, SharedFrameWriter* sharedFrameWriterPtr, bool headless)
+: mName(name)
+, mCameraNames(cameraNames)
+, mHeadless(headless)
+, mPatternSize(patternSize)
+, mQ(Q)
+, mDetectWorkers(std::max(detectWorkers, 1u))
+, mCameraHandlers()
+, mRunning(false)
+, mGrabbedQueues()
+, mRectifiedQueue(SV::PIPELINE_QUEUE_CAPACITY)
+, mPairedQueue(SV::PIPELINE_QUEUE_CAPACITY)
+, mMatchedQueue(SV::PIPELINE_QUEUE_CAPACITY)
+, mDetectedQueue(SV::PIPELINE_QUEUE_CAPACITY)
+, mDisplayMailbox()
+, mStereoSynchronizer(SV::SYNCHRONIZATION_MODE, SV::SYNCHRONIZATION_MAXIMUM_SKEW, SV::SYNCHRONIZATION_DEPTH)
+, mSharedFrameWriterPtr(sharedFrameWriterPtr)
+, mDisparityEngine()
+, mReprojector()
+, mDisparitySize()
+, mDisparityBufferPool(SV::FRAME_BUFFER_HUGE_PAGES)
+, mDisparitySlotRing(SV::DISPARITY_SLOTS)
+, mCornerTrackers()
+, mThreads()
+, mNewestId(0u)
+, mDisplaySize()
+, mDisplayBufferPool(SV::FRAME_BUFFER_HUGE_PAGES)
+, mInstrumentation()
+{
+    if (mCameraNames.size() != 2u)
+        throw std::runtime_error("StereoPipeline::StereoPipeline() - Expected a stereo pair of cameras");
+
+    for (size_t i = 0; i < mCameraNames.size(); ++i)
+        mGrabbedQueues.push_back(std::unique_ptr<SPSCQueue<SV::Frame>>(new SPSCQueue<SV::Frame>(SV::PIPELINE_QUEUE_CAPACITY)));
+
+    if (SV::CORNER_TRACKING)
+        mCornerTrackers.assign(mCameraNames.size(), CornerTracker(mPatternSize, SV::CORNER_TRACKING_WINDOW_SIZE,
+            SV::CORNER_TRACKING_PYRAMID_LEVELS, SV::CORNER_TRACKING_MAXIMUM_ERROR, SV::CHESSBOARD_PYRAMID_LEVELS));
+
+    if (SV::DENSE_DISPARITY)
+    {
+        mDisparityEngine.reset(new DisparityEngine(SV::DISPARITY_NUMBER, SV::DISPARITY_WINDOW_SIZE, SV::DISPARITY_TEXTURE_THRESHOLD,
+            SV::DISPARITY_LR_TOLERANCE, SV::DISPARITY_BANDS));
+        if (SV::DENSE_REPROJECTION)
+            mReprojector.reset(new Reprojector(mQ, SV::DISPARITY_NUMBER, SV::DISPARITY_BANDS));
+    }
+}
+
+StereoPipeline::~StereoPipeline()
+{
+    stop();
+}
+
+void StereoPipeline::start(std::vector<FrameHandler*> cameraHandlers)
+{
+    if (mRunning)
+        throw std::runtime_error("StereoPipeline::start() - Pipeline already running");
+    if (cameraHandlers.size() != mCameraNames.size())
+        throw std::runtime_error("StereoPipeline::start() - Expected one handler per camera");
+
+    mCameraHandlers = cameraHandlers;
+    mNewestId = 0u;
+    mRunning = true;
+
+    if (!mHeadless)
+    {
+        for (auto& cameraName : mCameraNames)
+            cv::namedWindow(cameraName, CV_WINDOW_AUTOSIZE);
+    }
+
+    for (size_t i = 0; i < mCameraHandlers.size(); ++i)
+        mThreads.push_back(std::thread(&StereoPipeline::preprocess, this, i));
+    mThreads.push_back(std::thread(&StereoPipeline::pair, this));
+    if (mDisparityEngine)
+        mThreads.push_back(std::thread(&StereoPipeline::match, this));
+    // Tracking needs the frames of each camera in order, so it replaces the detection worker pool with a single thread
+    auto detectWorkers = mCornerTrackers.empty() ? mDetectWorkers : 0u;
+    for (unsigned int i = 0; i < detectWorkers; ++i)
+        mThreads.push_back(std::thread(&StereoPipeline::detect, this));
+    if (!mCornerTrackers.empty())
+    {
+        for (auto& cornerTracker : mCornerTrackers)
+            cornerTracker.reset();
+        mThreads.push_back(std::thread(&StereoPipeline::track, this));
+    }
+    mThreads.push_back(std::thread(&StereoPipeline::triangulate, this));
+
+    std::cout << (mName.empty() ? "Pipeline" : "Pipeline " + mName) << " started with " << mThreads.size() << " threads (" << (mCornerTrackers.empty() ? std::to_string(detectWorkers) + " detection workers" : "corner tracking") << ")." << std::endl;
+}
+
+void StereoPipeline::stop()
+{
+    if (mThreads.empty())
+        return;
+
+    mRunning = false;
+    for (auto& thread : mThreads)
+        thread.join();
+    mThreads.clear();
+
+    if (!mName.empty())
+        std::cout << "Pipeline " << mName << ":" << std::endl;
+    mInstrumentation.dump(std::cout);
+    auto statistics = mStereoSynchronizer.getStatistics();
+    std::cout << "Paired " << statistics.pairs << " stereo frames, dropped " << statistics.orphans << " orphans; skew mean "
+        << statistics.meanSkew << ", max " << statistics.maximumSkew << "; realigned frame IDs " << statistics.realignments << " times" << std::endl;
+    for (size_t i = 0; i < mCornerTrackers.size(); ++i)
+    {
+        auto trackerStatistics = mCornerTrackers[i].getStatistics();
+        std::cout << mCameraNames[i] << ": tracked the chessboard in " << trackerStatistics.tracked << " frames, detected it in "
+            << trackerStatistics.detected << ", lost track " << trackerStatistics.lost << " times" << std::endl;
+    }
+
+    // Frames still queued hold rectified buffers of the handlers; hand them back before the handlers go away
+    for (auto& queue : mGrabbedQueues)
+        drain<SPSCQueue<SV::Frame>, SV::Frame>(*queue);
+    drain<MPMCQueue<SV::Frame>, SV::Frame>(mRectifiedQueue);
+    drain<MPMCQueue<SV::StereoFrame>, SV::StereoFrame>(mPairedQueue);
+    drain<MPMCQueue<SV::StereoFrame>, SV::StereoFrame>(mMatchedQueue);
+    drain<MPMCQueue<SV::StereoFrame>, SV::StereoFrame>(mDetectedQueue);
+    mDisplayMailbox.clear();
+}
+
+const std::string& StereoPipeline::getName() const
+{
+    return mName;
+}
+
+bool StereoPipeline::submitGrabbed(size_t camera, SV::Frame&& frame, bool wait)
+{
+    mInstrumentation.count(SV::COUNTER_GRABBED);
+    auto& queue = *mGrabbedQueues[camera];
+    if (wait)
+        return pushWait(queue, std::move(frame), mRunning);
+    if (queue.tryPush(std::move(frame)))
+        return true;
+
+    mInstrumentation.count(SV::COUNTER_DROPPED_BUSY);
+    return false;
+}
+
+Instrumentation* StereoPipeline::getInstrumentation()
+{
+    return &mInstrumentation;
+}
+
+double StereoPipeline::getProcessingPeriod() const
+{
+    auto mean = [this](SV::Stage stage) { return mInstrumentation.getSummary(stage).mean; };
+
+    // Stages sharing a thread add up; detection workers split their stage
+    auto preprocessing = mean(SV::STAGE_GRAY) + mean(SV::STAGE_THRESHOLD) + mean(SV::STAGE_REMAP);
+    auto detection = mean(SV::STAGE_DETECTION) / (mCornerTrackers.empty() ? mDetectWorkers : 1u);
+    // The present stage drops pairs instead of holding the others back
+    auto slowest = std::max({ preprocessing, mean(SV::STAGE_MATCH), detection, mean(SV::STAGE_TRIANGULATION) });
+    return slowest * 1e-9;
+}
+
+void StereoPipeline::submitRectified(SV::Frame&& frame)
+{
+    mInstrumentation.count(SV::COUNTER_RECTIFIED);
+    pushWait(mRectifiedQueue, std::move(frame), mRunning);
+}
+
+bool StereoPipeline::present(unsigned int timeout)
+{
+    SV::StereoFrame stereoFrame;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+    Backoff backoff;
+    while (!mDisplayMailbox.take(stereoFrame))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        backoff.wait();
+    }
+
+    mInstrumentation.count(SV::COUNTER_PRESENTED);
+    Instrumentation::ScopedTimer drawingTimer(&mInstrumentation, SV::STAGE_DRAWING);
+
+    auto undistortedImageLeft = stereoFrame.left.image;
+    auto undistortedImageRight = stereoFrame.right.image;
+    if (undistortedImageLeft.size() != mDisplaySize)
+        allocateDisplayBuffers(undistortedImageLeft.size());
+
+    auto leftImage = mDisplayBufferPool.getBuffer(LEFT_DISPLAY_BUFFER);
+    auto rightImage = mDisplayBufferPool.getBuffer(RIGHT_DISPLAY_BUFFER);
+    auto leftImageHalf = mDisplayBufferPool.getBuffer(LEFT_DISPLAY_HALF_BUFFER);
+    auto rightImageHalf = mDisplayBufferPool.getBuffer(RIGHT_DISPLAY_HALF_BUFFER);
+
+    cv::cvtColor(undistortedImageLeft, leftImage, CV_GRAY2BGR);
+    cv::cvtColor(undistortedImageRight, rightImage, CV_GRAY2BGR);
+
+    auto& cornersLeft = stereoFrame.cornersLeft;
+    auto& cornersRight = stereoFrame.cornersRight;
+    if (!stereoFrame.points.empty())
+    {
+        // Drawings
+        drawChessboardCorners(leftImage, mPatternSize, cv::Mat(cornersLeft), stereoFrame.foundLeft);
+        drawChessboardCorners(rightImage, mPatternSize, cv::Mat(cornersRight), stereoFrame.foundRight);
+        auto& points = stereoFrame.points;
+        for (auto i : {size_t(0), points.size() - 1})
+        {
+            std::string imageText("(" + std::to_string(points.x[i]).substr(0,7) +
+                                ", " + std::to_string(points.y[i]).substr(0,7) +
+                                ", " + std::to_string(points.z[i]).substr(0,7) + ")");
+
+            cv::putText(leftImage, imageText,
+                cv::Point2f(cornersLeft[i].x, cornersLeft[i].y),
+                CV_FONT_HERSHEY_SCRIPT_SIMPLEX, 2, cv::Scalar(0, 0, 255), 3, 8);
+
+            cv::putText(rightImage, imageText,
+                cv::Point2f(cornersRight[i].x, cornersRight[i].y),
+                CV_FONT_HERSHEY_SCRIPT_SIMPLEX, 2, cv::Scalar(0, 0, 255), 3, 8);
+        }
+    }
+
+    cv::resize(leftImage, leftImageHalf, leftImageHalf.size());
+    cv::resize(rightImage, rightImageHalf, rightImageHalf.size());
+    {
+        Instrumentation::ScopedTimer displayTimer(&mInstrumentation, SV::STAGE_DISPLAY);
+        cv::imshow(mCameraNames[0], leftImageHalf);
+        cv::imshow(mCameraNames[1], rightImageHalf);
+    }
+
+    auto& disparity = stereoFrame.disparity.image;
+    if (!disparity.empty())
+    {
+        // 1/16 pixel fixed point to 8 bits over the search range; invalid (negative) disparities saturate to black
+        auto disparityImage = mDisplayBufferPool.getBuffer(DISPARITY_DISPLAY_BUFFER);
+        auto disparityImageHalf = mDisplayBufferPool.getBuffer(DISPARITY_DISPLAY_HALF_BUFFER);
+        disparity.convertTo(disparityImage, CV_8U, 255.0 / (mDisparityEngine->getNumberOfDisparities() * DisparityEngine::DISPARITY_SCALE));
+        cv::resize(disparityImage, disparityImageHalf, disparityImageHalf.size());
+        Instrumentation::ScopedTimer displayTimer(&mInstrumentation, SV::STAGE_DISPLAY);
+        cv::imshow(mName.empty() ? DISPARITY_WINDOW : mName + " " + DISPARITY_WINDOW, disparityImageHalf);
+    }
+
+    return true;
+}
+
+void StereoPipeline::preprocess(size_t camera)
+{
+    auto& queue = *mGrabbedQueues[camera];
+    SV::Frame frame;
+    while (popWait(queue, frame, mRunning))
+    {
+        mCameraHandlers[camera]->onFrameGrabbed(frame);
+        frame = SV::Frame();
+    }
+}
+
+void StereoPipeline::pair()
+{
+    SV::Frame frame;
+    while (popWait(mRectifiedQueue, frame, mRunning))
+    {
+        SV::StereoFrame stereoFrame;
+        if (mStereoSynchronizer.push(std::move(frame), stereoFrame.left, stereoFrame.right))
+        {
+            mInstrumentation.count(SV::COUNTER_PAIRED);
+            // One copy per image into the ring; readers never hold the pipeline's buffers
+            if (mSharedFrameWriterPtr)
+                mSharedFrameWriterPtr->publish(stereoFrame.left, stereoFrame.right);
+            pushWait(mDisparityEngine ? mPairedQueue : mMatchedQueue, std::move(stereoFrame), mRunning);
+        }
+        frame = SV::Frame();
+    }
+    // Waiting frames hold rectified buffers too
+    mStereoSynchronizer.clear();
+}
+
+void StereoPipeline::match()
+{
+    // A single thread: the engine already splits each pair into row bands over the OpenCV thread pool
+    SV::StereoFrame stereoFrame;
+    while (popWait(mPairedQueue, stereoFrame, mRunning))
+    {
+        auto imageSize = stereoFrame.left.image.size();
+        if (imageSize != mDisparitySize && mDisparitySlotRing.getFreeSlots() == mDisparitySlotRing.getSlots())
+            allocateDisparityBuffers(imageSize);
+
+        // Every disparity buffer is in flight (or the old size is still on screen): pass the pair on without one
+        size_t slot;
+        std::shared_ptr<void> owner;
+        if (imageSize == mDisparitySize && mDisparitySlotRing.tryAcquire(slot, owner))
+        {
+            Instrumentation::ScopedTimer matchTimer(&mInstrumentation, SV::STAGE_MATCH);
+            auto disparity = mDisparityBufferPool.getBuffer(DISPARITY_SLOT_BUFFERS * slot);
+            mDisparityEngine->compute(stereoFrame.left.image, stereoFrame.right.image, disparity);
+            if (mReprojector)
+            {
+                auto& cloud = stereoFrame.cloud;
+                cloud.x = mDisparityBufferPool.getBuffer(DISPARITY_SLOT_BUFFERS * slot + 1u);
+                cloud.y = mDisparityBufferPool.getBuffer(DISPARITY_SLOT_BUFFERS * slot + 2u);
+                cloud.z = mDisparityBufferPool.getBuffer(DISPARITY_SLOT_BUFFERS * slot + 3u);
+                mReprojector->reproject(disparity, cloud);
+            }
+
+            stereoFrame.disparity.image = disparity;
+            stereoFrame.disparity.camera = stereoFrame.left.camera;
+            stereoFrame.disparity.id = stereoFrame.left.id;
+            stereoFrame.disparity.timestamp = stereoFrame.left.timestamp;
+            stereoFrame.disparity.owner = std::move(owner);
+        }
+        else
+        {
+            mInstrumentation.count(SV::COUNTER_DROPPED_DISPARITY);
+        }
+
+        pushWait(mMatchedQueue, std::move(stereoFrame), mRunning);
+        stereoFrame = SV::StereoFrame();
+    }
+}
+
+void StereoPipeline::detect()
+{
+    SV::StereoFrame stereoFrame;
+    while (popWait(mMatchedQueue, stereoFrame, mRunning))
+    {
+        stereoFrame.cornersLeft.reserve(mPatternSize.area());
+        stereoFrame.cornersRight.reserve(mPatternSize.area());
+        {
+            Instrumentation::ScopedTimer detectionTimer(&mInstrumentation, SV::STAGE_DETECTION);
+            stereoFrame.foundLeft = SV::findChessboardCornersCoarseToFine(stereoFrame.left.image, mPatternSize, stereoFrame.cornersLeft,
+                SV::CHESSBOARD_PYRAMID_LEVELS);
+            stereoFrame.foundRight = SV::findChessboardCornersCoarseToFine(stereoFrame.right.image, mPatternSize, stereoFrame.cornersRight,
+                SV::CHESSBOARD_PYRAMID_LEVELS);
+        }
+
+        pushWait(mDetectedQueue, std::move(stereoFrame), mRunning);
+        stereoFrame = SV::StereoFrame();
+    }
+}
+
+void StereoPipeline::track()
+{
+    SV::StereoFrame stereoFrame;
+    while (popWait(mMatchedQueue, stereoFrame, mRunning))
+    {
+        {
+            Instrumentation::ScopedTimer detectionTimer(&mInstrumentation, SV::STAGE_DETECTION);
+            stereoFrame.foundLeft = mCornerTrackers[0].findCorners(stereoFrame.left.image, stereoFrame.cornersLeft);
+            stereoFrame.foundRight = mCornerTrackers[1].findCorners(stereoFrame.right.image, stereoFrame.cornersRight);
+        }
+
+        pushWait(mDetectedQueue, std::move(stereoFrame), mRunning);
+        stereoFrame = SV::StereoFrame();
+    }
+}
+
+void StereoPipeline::triangulate()
+{
+    // Reused from frame to frame
+    SV::Points2D pointsLeft, pointsRight;
+    SV::StereoFrame stereoFrame;
+    while (popWait(mDetectedQueue, stereoFrame, mRunning))
+    {
+        auto& cornersLeft = stereoFrame.cornersLeft;
+        auto& cornersRight = stereoFrame.cornersRight;
+        if (stereoFrame.foundLeft && stereoFrame.foundRight && cornersLeft.size() == cornersRight.size())
+        {
+            auto& points = stereoFrame.points;
+            {
+                Instrumentation::ScopedTimer triangulationTimer(&mInstrumentation, SV::STAGE_TRIANGULATION);
+                SV::toPoints2D(cornersLeft, pointsLeft);
+                SV::toPoints2D(cornersRight, pointsRight);
+                SV::triangulate(mQ, pointsLeft, pointsRight, points);
+            }
+
+            auto last = points.size() - 1;
+            printf("Triangulated %u corners >> first X: %f; Y: %f; Z: %f; last X: %f; Y: %f; Z: %f;\n", (unsigned int) points.size(),
+                points.x[0], points.y[0], points.z[0], points.x[last], points.y[last], points.z[last]);
+        }
+
+        // Never waits for the display; detection workers may finish out of order, so never step back in time either
+        if (!mHeadless)
+        {
+            if (stereoFrame.right.id < mNewestId)
+                mInstrumentation.count(SV::COUNTER_DROPPED_PRESENT);
+            else
+            {
+                mNewestId = stereoFrame.right.id;
+                if (mDisplayMailbox.post(std::move(stereoFrame)))
+                    mInstrumentation.count(SV::COUNTER_DROPPED_DISPLAY);
+            }
+        }
+        stereoFrame = SV::StereoFrame();
+    }
+}
+
+void StereoPipeline::allocateDisplayBuffers(cv::Size imageSize)
+{
+    auto halfSize = cv::Size(imageSize.width / 2, imageSize.height / 2);
+    mDisplayBufferPool.allocate(
+    {
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC3),
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC3),
+        FrameBufferPool::BufferLayout(halfSize, CV_8UC3),
+        FrameBufferPool::BufferLayout(halfSize, CV_8UC3),
+        FrameBufferPool::BufferLayout(imageSize, CV_8UC1),
+        FrameBufferPool::BufferLayout(halfSize, CV_8UC1)
+    });
+    mDisplaySize = imageSize;
+}
+
+void StereoPipeline::allocateDisparityBuffers(cv::Size imageSize)
+{
+    std::vector<FrameBufferPool::BufferLayout> layouts;
+    for (size_t i = 0; i < SV::DISPARITY_SLOTS; ++i)
+    {
+        layouts.push_back(FrameBufferPool::BufferLayout(imageSize, CV_16SC1));
+        // X, Y and Z planes of the point cloud
+        for (size_t j = 1; j < DISPARITY_SLOT_BUFFERS; ++j)
+            layouts.push_back(FrameBufferPool::BufferLayout(mReprojector ? imageSize : cv::Size(), CV_32FC1));
+    }
+    mDisparityBufferPool.allocate(layouts);
+    mDisparitySize = imageSize;
+}
@@ -0,0 +1,100 @@
+#include <SV/StereoRig.hpp>
+#include <SV/StereoPipeline.hpp>
+#include <SV/Instrumentation.hpp>
+
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+    // Frame source poll interval, so the grab thread notices stop() promptly
+    const unsigned int GRAB_TIMEOUT = 100u;
+}
+
+
+StereoRig::StereoRig()
+: mPipelines()
+, mRoutes()
+, mFrameSource(nullptr)
+, mRunning(false)
+, mGrabbing(false)
+, mThread()
+{
+}
+
+StereoRig::~StereoRig()
+{
+    stop();
+}
+
+void StereoRig::addPair(StereoPipeline* stereoPipelinePtr, size_t left, size_t right)
+{
+    if (mRunning)
+        throw std::runtime_error("StereoRig::addPair() - Rig already running");
+
+    auto cameras = std::max(left, right) + 1u;
+    if (mRoutes.size() < cameras)
+        mRoutes.resize(cameras, Route{nullptr, 0u});
+    if (mRoutes[left].pipeline || mRoutes[right].pipeline || left == right)
+        throw std::runtime_error("StereoRig::addPair() - Camera already in a pair");
+
+    mRoutes[left] = Route{stereoPipelinePtr, 0u};
+    mRoutes[right] = Route{stereoPipelinePtr, 1u};
+    mPipelines.push_back(stereoPipelinePtr);
+}
+
+void StereoRig::start(FrameSource* frameSource)
+{
+    if (mRunning)
+        throw std::runtime_error("StereoRig::start() - Rig already running");
+
+    mFrameSource = frameSource;
+    mRunning = true;
+    mGrabbing = true;
+    mThread = std::thread(&StereoRig::grab, this);
+}
+
+void StereoRig::stop()
+{
+    if (!mThread.joinable())
+        return;
+
+    mRunning = false;
+    mThread.join();
+}
+
+bool StereoRig::isRunning() const
+{
+    return mRunning && mGrabbing;
+}
+
+const std::vector<StereoPipeline*>& StereoRig::getPipelines() const
+{
+    return mPipelines;
+}
+
+void StereoRig::grab()
+{
+    auto wait = mPipelines.size() == 1u;
+    while (mRunning)
+    {
+        if (!mFrameSource->isGrabbing())
+        {
+            mGrabbing = false;
+            break;
+        }
+
+        SV::Frame frame;
+        auto waitStart = std::chrono::steady_clock::now();
+        if (!mFrameSource->retrieveFrame(frame, GRAB_TIMEOUT) || frame.camera >= mRoutes.size() || !mRoutes[frame.camera].pipeline)
+            continue;
+
+        auto& route = mRoutes[frame.camera];
+        route.pipeline->getInstrumentation()->record(SV::STAGE_GRAB_WAIT, std::chrono::steady_clock::now() - waitStart);
+        frame.camera = route.camera;
+        route.pipeline->submitGrabbed(route.camera, std::move(frame), wait);
+    }
+}
@@ -0,0 +1,147 @@
+#include <SV/StereoSynchronizer.hpp>
+
+#include <limits>
+#include <algorithm>
+#include <utility>
+#include <stdexcept>
+
+
+namespace
+{
+    uint64_t absoluteDifference(uint64_t a, uint64_t b)
+    {
+        return a > b ? a - b : b - a;
+    }
+}
+
+
+StereoSynchronizer::StereoSynchronizer(SV::SynchronizationMode synchronizationMode, uint64_t maximumSkew, size_t depth)
+: mSynchronizationMode(synchronizationMode)
+, mMaximumSkew(maximumSkew)
+, mDepth(std::max(depth, size_t(1)))
+, mPending()
+, mIdOffsets()
+, mUnpaired(0u)
+, mPairs(0u)
+, mOrphans(0u)
+, mSkewSum(0u)
+, mSkewMaximum(0u)
+, mRealignments(0u)
+{
+    mIdOffsets.fill(0u);
+    // One extra entry: a frame is appended before the oldest one is dropped
+    for (auto& pending : mPending)
+        pending.reserve(mDepth + 1u);
+}
+
+bool StereoSynchronizer::push(SV::Frame&& frame, SV::Frame& left, SV::Frame& right)
+{
+    if (frame.camera > 1u)
+        throw std::runtime_error("StereoSynchronizer::push() - Frame does not belong to a stereo pair");
+
+    auto camera = frame.camera;
+    auto key = getKey(frame);
+    auto& pending = mPending[camera];
+    auto& pendingOther = mPending[1u - camera];
+
+    // Closest frame of the other camera
+    size_t match = pendingOther.size();
+    auto matchSkew = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < pendingOther.size(); ++i)
+    {
+        auto skew = absoluteDifference(getKey(pendingOther[i]), key);
+        if (skew < matchSkew)
+        {
+            match = i;
+            matchSkew = skew;
+        }
+    }
+
+    if (match < pendingOther.size() && matchSkew <= mMaximumSkew)
+    {
+        auto& matchedLeft = camera == 0u ? frame : pendingOther[match];
+        auto& matchedRight = camera == 0u ? pendingOther[match] : frame;
+        left = std::move(matchedLeft);
+        right = std::move(matchedRight);
+
+        // Older frames on either side would pair out of order: drop them
+        dropFront(pendingOther, match + 1u);
+        mOrphans.fetch_add(match + pending.size(), std::memory_order_relaxed);
+        pending.clear();
+
+        mUnpaired = 0u;
+        mPairs.fetch_add(1u, std::memory_order_relaxed);
+        mSkewSum.fetch_add(matchSkew, std::memory_order_relaxed);
+        if (matchSkew > mSkewMaximum.load(std::memory_order_relaxed))
+            mSkewMaximum.store(matchSkew, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Frames of one camera arrive in order, so other-camera frames already too old for this one never match
+    size_t expired = 0;
+    while (expired < pendingOther.size() && getKey(pendingOther[expired]) + mMaximumSkew < key)
+        ++expired;
+    dropFront(pendingOther, expired);
+    mOrphans.fetch_add(expired, std::memory_order_relaxed);
+
+    pending.push_back(std::move(frame));
+    if (pending.size() > mDepth)
+    {
+        dropFront(pending, 1u);
+        mOrphans.fetch_add(1u, std::memory_order_relaxed);
+    }
+
+    // Frame IDs are counters of each camera: one that started late or skipped a frame stays offset for good, and no
+    // frame would ever pair again. Once both cameras have filled their window without a pair, map their newest frames
+    // onto each other
+    if (mSynchronizationMode == SV::SYNCHRONIZE_BY_FRAME_ID && ++mUnpaired >= 2u * mDepth && !pendingOther.empty())
+        realign();
+    return false;
+}
+
+void StereoSynchronizer::clear()
+{
+    for (auto& pending : mPending)
+    {
+        mOrphans.fetch_add(pending.size(), std::memory_order_relaxed);
+        pending.clear();
+    }
+}
+
+StereoSynchronizer::Statistics StereoSynchronizer::getStatistics() const
+{
+    Statistics statistics;
+    statistics.pairs = mPairs.load(std::memory_order_relaxed);
+    statistics.orphans = mOrphans.load(std::memory_order_relaxed);
+    statistics.maximumSkew = mSkewMaximum.load(std::memory_order_relaxed);
+    statistics.realignments = mRealignments.load(std::memory_order_relaxed);
+    statistics.meanSkew = statistics.pairs > 0u ? double(mSkewSum.load(std::memory_order_relaxed)) / statistics.pairs : 0.0;
+    return statistics;
+}
+
+uint64_t StereoSynchronizer::getKey(const SV::Frame& frame) const
+{
+    return mSynchronizationMode == SV::SYNCHRONIZE_BY_TIMESTAMP ? frame.timestamp : frame.id + mIdOffsets[frame.camera];
+}
+
+void StereoSynchronizer::realign()
+{
+    // Without a shared clock the newest frames are the closest in time that is known, within one frame period.
+    // Offsets only grow, so keys of each camera keep increasing
+    auto keyLeft = getKey(mPending[0].back());
+    auto keyRight = getKey(mPending[1].back());
+    if (keyLeft > keyRight)
+        mIdOffsets[1] += keyLeft - keyRight;
+    else
+        mIdOffsets[0] += keyRight - keyLeft;
+
+    // Frames still waiting are keyed the old way; their partners are gone anyway
+    clear();
+    mUnpaired = 0u;
+    mRealignments.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void StereoSynchronizer::dropFront(std::vector<SV::Frame>& pending, size_t count)
+{
+    pending.erase(pending.begin(), pending.begin() + count);
+}
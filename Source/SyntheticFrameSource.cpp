@@ -0,0 +1,303 @@
+#include <SV/SyntheticFrameSource.hpp>
+#include <SV/Rectifier.hpp>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/calib3d/calib3d.hpp>
+
+#include <cmath>
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace
+{
+    const double PI = 3.14159265358979323846;
+
+    // Gray levels of the scene; the board keeps a white margin of one square for the detector
+    const int BLACK = 40;
+    const int WHITE = 215;
+    const int BACKGROUND = 110;
+
+    // BayerGB8 response of the gray scene, as a sensor without white balance: green is the most sensitive
+    const float BLUE_GAIN = 0.8f;
+    const float RED_GAIN = 0.9f;
+
+    // Renders rows of one image: every pixel averages 2x2 samples around its center, through the homography from the
+    // image to the board plane (in squares, the first inner corner at the origin)
+    class RenderBody : public cv::ParallelLoopBody
+    {
+        public:
+            RenderBody(const cv::Matx33d& imageToBoard, cv::Size patternSize, SV::PixelFormat pixelFormat, cv::Mat& image)
+            : mImageToBoard(imageToBoard)
+            , mPatternSize(patternSize)
+            , mPixelFormat(pixelFormat)
+            , mImage(image)
+            {
+            }
+
+            virtual void operator()(const cv::Range& range) const
+            {
+                const double offsets[2] = {-0.25, 0.25};
+                auto& h = mImageToBoard;
+                for (int y = range.start; y < range.end; ++y)
+                {
+                    auto row = mImage.ptr<unsigned char>(y);
+                    for (int x = 0; x < mImage.cols; ++x)
+                    {
+                        auto sum = 0;
+                        for (auto dy : offsets)
+                        {
+                            for (auto dx : offsets)
+                            {
+                                auto u = x + dx, v = y + dy;
+                                auto w = h(2, 0) * u + h(2, 1) * v + h(2, 2);
+                                sum += w > 0. ? sample((h(0, 0) * u + h(0, 1) * v + h(0, 2)) / w, (h(1, 0) * u + h(1, 1) * v + h(1, 2)) / w) : BACKGROUND;
+                            }
+                        }
+
+                        auto value = sum * 0.25f;
+                        if (mPixelFormat == SV::PIXEL_FORMAT_BAYERGB8 && (x + y) % 2 != 0)
+                            value *= y % 2 == 0 ? BLUE_GAIN : RED_GAIN;
+                        row[x] = (unsigned char) (value + 0.5f);
+                    }
+                }
+            }
+
+
+        private:
+            int sample(double boardX, double boardY) const
+            {
+                // Squares span [-1, W] x [-1, H]; the margin one more square around them
+                if (boardX < -2. || boardY < -2. || boardX >= mPatternSize.width + 2. || boardY >= mPatternSize.height + 2.)
+                    return BACKGROUND;
+                if (boardX < -1. || boardY < -1. || boardX >= mPatternSize.width + 1. || boardY >= mPatternSize.height + 1.)
+                    return WHITE;
+                return ((int) std::floor(boardX) + (int) std::floor(boardY)) % 2 == 0 ? BLACK : WHITE;
+            }
+
+
+        private:
+            cv::Matx33d         mImageToBoard;
+            cv::Size            mPatternSize;
+            SV::PixelFormat     mPixelFormat;
+            cv::Mat&            mImage;
+    };
+}
+
+
+SyntheticFrameSource::SyntheticFrameSource(const Parameters& parameters)
+: mParameters(parameters)
+, mImages()
+, mGroundTruth()
+, mCalibrationBundle()
+, mOpen(false)
+, mGrabbing(false)
+, mNextFrame(0u)
+, mGrabStart()
+{
+    if (mParameters.focalLength <= 0.)
+        mParameters.focalLength = mParameters.imageSize.width;
+    // Board and margins across half of the image width
+    if (mParameters.distance <= 0.)
+        mParameters.distance = mParameters.focalLength * (mParameters.patternSize.width + 3) * mParameters.squareSize / (0.5 * mParameters.imageSize.width);
+}
+
+void SyntheticFrameSource::open()
+{
+    if (mParameters.imageSize.width <= 0 || mParameters.imageSize.height <= 0 || mParameters.patternSize.width < 2 || mParameters.patternSize.height < 2 ||
+        mParameters.squareSize <= 0.f || mParameters.baseline <= 0. || mParameters.poses == 0u)
+        throw std::runtime_error("SyntheticFrameSource::open() - Invalid rig parameters");
+    if (mParameters.pixelFormat != SV::PIXEL_FORMAT_MONO8 && mParameters.pixelFormat != SV::PIXEL_FORMAT_BAYERGB8)
+        throw std::runtime_error("SyntheticFrameSource::open() - Expected Mono8 or BayerGB8");
+
+    mImages.assign(mParameters.poses, std::array<cv::Mat, 2>());
+    mGroundTruth.assign(mParameters.poses, GroundTruth());
+    for (size_t pose = 0; pose < mParameters.poses; ++pose)
+        renderPose(pose);
+    createCalibration();
+    mNextFrame = 0u;
+    mOpen = true;
+}
+
+void SyntheticFrameSource::close()
+{
+    mGrabbing = false;
+    mOpen = false;
+}
+
+bool SyntheticFrameSource::isOpen() const
+{
+    return mOpen;
+}
+
+void SyntheticFrameSource::startGrabbing()
+{
+    mGrabbing = mOpen;
+    mGrabStart = std::chrono::steady_clock::now();
+    mNextFrame = 0u;
+}
+
+void SyntheticFrameSource::stopGrabbing()
+{
+    mGrabbing = false;
+}
+
+bool SyntheticFrameSource::isGrabbing() const
+{
+    return mGrabbing;
+}
+
+bool SyntheticFrameSource::retrieveFrame(SV::Frame& frame, unsigned int timeout)
+{
+    if (!mGrabbing)
+        return false;
+
+    auto id = mNextFrame / 2u;
+    if (mParameters.frameRate > 0.)
+    {
+        // Both cameras of a pair are exposed together
+        auto due = mGrabStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(id / mParameters.frameRate));
+        if (due > std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+            return false;
+        }
+        std::this_thread::sleep_until(due);
+    }
+
+    auto camera = mNextFrame % 2u;
+    frame.image = mImages[id % mImages.size()][camera];
+    frame.camera = camera;
+    frame.id = id;
+    frame.timestamp = frame.id;
+    frame.pixelFormat = mParameters.pixelFormat;
+    frame.owner.reset();
+    ++mNextFrame;
+
+    return true;
+}
+
+size_t SyntheticFrameSource::getNumberOfCameras() const
+{
+    return 2u;
+}
+
+cv::Size SyntheticFrameSource::getImageSize(size_t camera) const
+{
+    return mParameters.imageSize;
+}
+
+std::shared_ptr<const CalibrationBundle> SyntheticFrameSource::getCalibrationBundle(size_t left, size_t right) const
+{
+    return left == 0u && right == 1u ? mCalibrationBundle : nullptr;
+}
+
+const SyntheticFrameSource::GroundTruth& SyntheticFrameSource::getGroundTruth(uint64_t id) const
+{
+    return mGroundTruth[id % mGroundTruth.size()];
+}
+
+const SyntheticFrameSource::Parameters& SyntheticFrameSource::getParameters() const
+{
+    return mParameters;
+}
+
+void SyntheticFrameSource::createCalibration()
+{
+    // What stereoCalibrate and stereoRectify give for this rig: no distortion, no rotation, the right camera at T = (-baseline, 0, 0)
+    auto f = mParameters.focalLength, b = mParameters.baseline;
+    auto cx = mParameters.imageSize.width / 2., cy = mParameters.imageSize.height / 2.;
+    cv::Mat M = (cv::Mat_<double>(3, 3) << f, 0., cx, 0., f, cy, 0., 0., 1.);
+    cv::Mat D = cv::Mat::zeros(1, 5, CV_64F);
+    cv::Mat R = cv::Mat::eye(3, 3, CV_64F);
+    cv::Mat P1 = (cv::Mat_<double>(3, 4) << f, 0., cx, 0., 0., f, cy, 0., 0., 0., 1., 0.);
+    cv::Mat P2 = (cv::Mat_<double>(3, 4) << f, 0., cx, -f * b, 0., f, cy, 0., 0., 0., 1., 0.);
+    cv::Mat Q = (cv::Mat_<double>(4, 4) << 1., 0., 0., -cx, 0., 1., 0., -cy, 0., 0., 0., f, 0., 0., 1. / b, 0.);
+
+    // Identity maps: the images are rectified already
+    cv::Mat mx(mParameters.imageSize, CV_32FC1), my(mParameters.imageSize, CV_32FC1);
+    for (int y = 0; y < mx.rows; ++y)
+    {
+        auto rowX = mx.ptr<float>(y);
+        auto rowY = my.ptr<float>(y);
+        for (int x = 0; x < mx.cols; ++x)
+        {
+            rowX[x] = (float) x;
+            rowY[x] = (float) y;
+        }
+    }
+
+    std::vector<CalibrationBundle::NamedMatrix> matrices
+    {
+        CalibrationBundle::NamedMatrix("M1", M),
+        CalibrationBundle::NamedMatrix("D1", D),
+        CalibrationBundle::NamedMatrix("R1", R),
+        CalibrationBundle::NamedMatrix("P1", P1),
+        CalibrationBundle::NamedMatrix("M2", M),
+        CalibrationBundle::NamedMatrix("D2", D),
+        CalibrationBundle::NamedMatrix("R2", R),
+        CalibrationBundle::NamedMatrix("P2", P2),
+        CalibrationBundle::NamedMatrix("Q", Q),
+        CalibrationBundle::NamedMatrix("mx1", mx),
+        CalibrationBundle::NamedMatrix("my1", my),
+        CalibrationBundle::NamedMatrix("mx2", mx),
+        CalibrationBundle::NamedMatrix("my2", my)
+    };
+    for (auto suffix : {"1", "2"})
+    {
+        auto fixedPointMaps = Rectifier::createFixedPointMaps(mx, my, suffix);
+        matrices.insert(matrices.end(), fixedPointMaps.begin(), fixedPointMaps.end());
+    }
+    mCalibrationBundle = CalibrationBundle::createFromMatrices(matrices);
+}
+
+void SyntheticFrameSource::renderPose(size_t pose)
+{
+    // The board sways and tilts around a point midway between the cameras; one cycle over all poses
+    auto phase = 2. * PI * pose / mParameters.poses;
+    auto distance = mParameters.distance;
+    cv::Mat rotation = (cv::Mat_<double>(3, 1) << 0.3 * std::sin(phase), 0.4 * std::sin(2. * phase + 1.), 0.15 * std::sin(phase + 0.5));
+    cv::Mat rotationMatrix;
+    cv::Rodrigues(rotation, rotationMatrix);
+    cv::Matx33d R(rotationMatrix);
+    cv::Vec3d translation(mParameters.baseline / 2. + 0.1 * distance * std::sin(phase), 0.05 * distance * std::cos(2. * phase), distance * (1. + 0.15 * std::cos(phase)));
+
+    // Board point (X, Y) in squares, first inner corner at the origin, to left camera coordinates
+    auto s = (double) mParameters.squareSize;
+    cv::Vec3d center((mParameters.patternSize.width - 1) * s / 2., (mParameters.patternSize.height - 1) * s / 2., 0.);
+    cv::Vec3d axisX(R(0, 0) * s, R(1, 0) * s, R(2, 0) * s);
+    cv::Vec3d axisY(R(0, 1) * s, R(1, 1) * s, R(2, 1) * s);
+    cv::Vec3d origin = translation - R * center;
+
+    auto f = mParameters.focalLength;
+    auto cx = mParameters.imageSize.width / 2., cy = mParameters.imageSize.height / 2.;
+    cv::Matx33d K(f, 0., cx, 0., f, cy, 0., 0., 1.);
+    auto& groundTruth = mGroundTruth[pose];
+    for (int camera = 0; camera < 2; ++camera)
+    {
+        // The right camera sits at +baseline on the x axis of the left one
+        cv::Vec3d cameraOrigin = origin - cv::Vec3d(camera == 0 ? 0. : mParameters.baseline, 0., 0.);
+        cv::Matx33d boardToCamera(axisX[0], axisY[0], cameraOrigin[0], axisX[1], axisY[1], cameraOrigin[1], axisX[2], axisY[2], cameraOrigin[2]);
+        auto boardToImage = K * boardToCamera;
+
+        auto& image = mImages[pose][camera];
+        image.create(mParameters.imageSize, CV_8UC1);
+        cv::parallel_for_(cv::Range(0, image.rows), RenderBody(boardToImage.inv(), mParameters.patternSize, mParameters.pixelFormat, image));
+
+        auto& corners = camera == 0 ? groundTruth.cornersLeft : groundTruth.cornersRight;
+        for (int row = 0; row < mParameters.patternSize.height; ++row)
+        {
+            for (int col = 0; col < mParameters.patternSize.width; ++col)
+            {
+                auto point = boardToImage * cv::Vec3d(col, row, 1.);
+                corners.push_back(cv::Point2f((float) (point[0] / point[2]), (float) (point[1] / point[2])));
+                if (camera == 0)
+                {
+                    auto corner = boardToCamera * cv::Vec3d(col, row, 1.);
+                    groundTruth.corners.push_back(cv::Point3f((float) corner[0], (float) corner[1], (float) corner[2]));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include <SV/Triangulation.hpp>
+
+#include <stdexcept>
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    // Q as float coefficients, row major
+    struct Reprojection
+    {
+        explicit Reprojection(const cv::Mat& Q)
+        {
+            if (Q.rows != 4 || Q.cols != 4)
+                throw std::runtime_error("SV::triangulate() - Expected a 4x4 reprojection matrix");
+
+            if (Q.type() != CV_64FC1 && Q.type() != CV_32FC1)
+                throw std::runtime_error("SV::triangulate() - Expected a floating point reprojection matrix");
+
+            for (int row = 0; row < 4; ++row)
+                for (int col = 0; col < 4; ++col)
+                    q[row * 4 + col] = Q.type() == CV_64FC1 ? (float) Q.at<double>(row, col) : Q.at<float>(row, col);
+        }
+
+        float q[16];
+    };
+
+    void triangulateScalar(const Reprojection& r, const float* xLeft, const float* yLeft, const float* xRight,
+        float* X, float* Y, float* Z, size_t first, size_t count)
+    {
+        auto q = r.q;
+        for (size_t i = first; i < count; ++i)
+        {
+            auto x = xLeft[i];
+            auto y = yLeft[i];
+            auto d = x - xRight[i];
+            auto w = 1.f / (q[12] * x + q[13] * y + q[14] * d + q[15]);
+            X[i] = (q[0] * x + q[1] * y + q[2] * d + q[3]) * w;
+            Y[i] = (q[4] * x + q[5] * y + q[6] * d + q[7]) * w;
+            Z[i] = (q[8] * x + q[9] * y + q[10] * d + q[11]) * w;
+        }
+    }
+
+#if defined(__AVX__)
+    typedef __m256 Vector;
+    const size_t LANES = 8;
+    inline Vector load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, Vector v) { _mm256_storeu_ps(p, v); }
+    inline Vector set(float value) { return _mm256_set1_ps(value); }
+    inline Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+    inline Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+    inline Vector divide(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+#elif defined(__SSE2__)
+    typedef __m128 Vector;
+    const size_t LANES = 4;
+    inline Vector load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, Vector v) { _mm_storeu_ps(p, v); }
+    inline Vector set(float value) { return _mm_set1_ps(value); }
+    inline Vector add(Vector a, Vector b) { return _mm_add_ps(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+    inline Vector multiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+    inline Vector divide(Vector a, Vector b) { return _mm_div_ps(a, b); }
+#endif
+
+#if defined(__AVX__) || defined(__SSE2__)
+    // One row of Q applied to the lanes
+    inline Vector row(const Vector* q, Vector x, Vector y, Vector d)
+    {
+        return add(add(multiply(q[0], x), multiply(q[1], y)), add(multiply(q[2], d), q[3]));
+    }
+#endif
+}
+
+
+void SV::triangulate(const cv::Mat& Q, const float* xLeft, const float* yLeft, const float* xRight,
+    float* X, float* Y, float* Z, size_t count)
+{
+    Reprojection reprojection(Q);
+    size_t i = 0;
+
+#if defined(__AVX__) || defined(__SSE2__)
+    Vector q[16];
+    for (int k = 0; k < 16; ++k)
+        q[k] = set(reprojection.q[k]);
+
+    auto one = set(1.f);
+    for (; i + LANES <= count; i += LANES)
+    {
+        auto x = load(xLeft + i);
+        auto y = load(yLeft + i);
+        auto d = subtract(x, load(xRight + i));
+        auto w = divide(one, row(q + 12, x, y, d));
+        store(X + i, multiply(row(q, x, y, d), w));
+        store(Y + i, multiply(row(q + 4, x, y, d), w));
+        store(Z + i, multiply(row(q + 8, x, y, d), w));
+    }
+#endif
+
+    triangulateScalar(reprojection, xLeft, yLeft, xRight, X, Y, Z, i, count);
+}
+
+void SV::triangulate(const cv::Mat& Q, const Points2D& left, const Points2D& right, Points3D& points)
+{
+    if (left.size() != right.size())
+        throw std::runtime_error("SV::triangulate() - Left and right point counts differ");
+
+    points.resize(left.size());
+    if (left.empty())
+        return;
+    triangulate(Q, left.x.data(), left.y.data(), right.x.data(), points.x.data(), points.y.data(), points.z.data(), left.size());
+}
+
+void SV::toPoints2D(const std::vector<cv::Point2f>& points, Points2D& arrays)
+{
+    arrays.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        arrays.x[i] = points[i].x;
+        arrays.y[i] = points[i].y;
+    }
+}
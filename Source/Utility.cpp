@@ -1,34 +1,126 @@
 #include <SV/Utility.hpp>
+#include <SV/Rectifier.hpp>
 
 #include <iostream>
 #include <fstream>
 #include <ctime>
 #include <cstdio>
 #include <cstdlib>
-#include <unistd.h>
-#include <sys/types.h>
-#include <sys/wait.h>
+#include <stdexcept>
 
 
 // TODO: cross-platform configuration
 /* Camera Parameters */
-const int           SV::MAX_NUMBER_OF_CAMERAS = 2;
+// Cameras opened at most; Config/Rig/rig.xml groups them in stereo pairs
+const int           SV::MAX_NUMBER_OF_CAMERAS = 8;
 // Windows: default.pfs ; Linux: default_linux.pfs
 const char*         SV::CONFIGURATION_FILE = 
     "Config/Camera/default_linux.pfs";
     //"Config/Camera/default_linux_lowres.pfs";
     //"Config/Camera/default_linux_midres.pfs";
-// TODO: dynamic definition; Last checked 18-03-2014
-// Time spent (ticks) in each iteration of the main loop (Camera Capture)
-int                 SV::MAIN_LOOP_ITERATION_TIME = 0;//6899925;                 
-// Windows: 9018 ; Linux: 8192
-const int           SV::INTER_PACKET_DELAY = 8192;                                      
-// Windows: 6233 ; Linux: 4096
-const int           SV::FRAME_TRANSMISSION_DELAY = 4096 + SV::MAIN_LOOP_ITERATION_TIME; 
+// Schedule GevSCPD and GevSCFTD of every camera from the link budget, re-tuned from the measured processing time;
+// false keeps the delays of CONFIGURATION_FILE
+const bool          SV::BANDWIDTH_SCHEDULING = true;
+// Bytes per second of the NIC (or switch uplink) the cameras share: Gigabit Ethernet
+const double        SV::GIGE_LINK_BANDWIDTH = 125000000.;
+// Fraction of the link left unscheduled for resends and jitter
+const double        SV::GIGE_SCHEDULE_MARGIN = 0.1;
+// Relative change of the processing period that re-tunes the delays while capturing
+const double        SV::GIGE_RESCHEDULE_THRESHOLD = 0.1;
+// Packet buffer (bytes) of the switch port in front of the NIC, for BandwidthSimulator
+const size_t        SV::GIGE_SWITCH_BUFFER = 131072u;
+
+
+/* Memory Parameters */
+// Back frame buffers with huge pages (needs vm.nr_hugepages; falls back to transparent huge pages)
+const bool          SV::FRAME_BUFFER_HUGE_PAGES = false;
+
+
+/* Image Processing Parameters */
+// Bin BayerGB8 frames 2x2 while converting to gray; calibration and capture must agree, so recalibrate after changing it
+const bool          SV::BAYER_2X2_BINNING = false;
+// Search the chessboard on the image halved this many times, then refine at full resolution; 0 searches at full resolution
+const int           SV::CHESSBOARD_PYRAMID_LEVELS = 2;
+// Bytes of gray image per band of the parallel preprocessing of a frame; about half an L2 cache. 0 preprocesses whole frames
+const size_t        SV::PREPROCESSING_BAND_SIZE = 128u * 1024u;
+
+
+/* Pipeline Parameters */
+// Room in each queue between two capture pipeline stages
+const size_t        SV::PIPELINE_QUEUE_CAPACITY = 4u;
+// Rectified images of one camera that may be in flight at once (queues plus stages downstream)
+const size_t        SV::PIPELINE_FRAME_SLOTS = 16u;
+// Chessboard detection threads; 0 uses the cores left over by the other stages
+const unsigned int  SV::PIPELINE_DETECT_WORKERS = 0u;
+// Seconds between stage latency and frame counter summaries in capture mode; 0 prints one only when capture stops
+const unsigned int  SV::INSTRUMENTATION_DUMP_INTERVAL = 10u;
+// Stereo frames shown per second at most in capture mode; the newest pair replaces any not yet shown
+const unsigned int  SV::DISPLAY_REFRESH_RATE = 60u;
+
+
+/* Publishing Parameters */
+// Publish rectified pairs to other local processes (SharedFrameReader) in capture mode
+const bool          SV::SHARED_FRAME_RING = true;
+// shm_open name of the first rig pair, the others append _1, _2, ...; the rings appear under /dev/shm
+const std::string   SV::SHARED_FRAME_RING_NAME = "/StereoVision";
+// Pairs kept; a reader may fall this many pairs minus one behind before it loses any
+const size_t        SV::SHARED_FRAME_RING_SLOTS = 8u;
+
+
+/* Recording Parameters */
+// Bytes of frames written at once by FrameRecorder; 12 frames of 5 MP
+const size_t        SV::RECORDING_CHUNK_SIZE = 64u * 1024u * 1024u;
+// Chunks in memory: one filled while the others wait for the disk, absorbing its stalls
+const size_t        SV::RECORDING_CHUNKS = 4u;
+
+
+/* Corner Tracking Parameters */
+// Follow the chessboard from frame to frame in capture mode and run the full detector only when the track is lost
+const bool          SV::CORNER_TRACKING = true;
+// Lucas-Kanade window side and pyramid depth; deeper pyramids follow faster boards
+const int           SV::CORNER_TRACKING_WINDOW_SIZE = 21;
+const int           SV::CORNER_TRACKING_PYRAMID_LEVELS = 3;
+// Largest forward-backward flow error and pattern grid misfit (pixels) of a trusted track
+const float         SV::CORNER_TRACKING_MAXIMUM_ERROR = 1.0f;
+
+
+/* Disparity Parameters */
+// Dense block matching on the rectified pairs in capture mode (see DisparityEngine.hpp)
+const bool          SV::DENSE_DISPARITY = true;
+// Disparity search range in pixels; a multiple of 16
+const int           SV::DISPARITY_NUMBER = 128;
+// Odd SAD window side, 3 to 11
+const int           SV::DISPARITY_WINDOW_SIZE = 9;
+// Minimum sum of horizontal gradients inside the window; flat windows are marked invalid
+const int           SV::DISPARITY_TEXTURE_THRESHOLD = 100;
+// Largest left-right disagreement in pixels; negative disables the check
+const int           SV::DISPARITY_LR_TOLERANCE = 1;
+// Row bands matched in parallel; 0 uses one band per hardware thread
+const int           SV::DISPARITY_BANDS = 0;
+// Point cloud of each disparity map (Reprojector); reuses the disparity bands
+const bool          SV::DENSE_REPROJECTION = true;
+// Disparity maps (and point clouds) in flight at once, about 70 MB each at 5 MP; pairs beyond them go on without one
+const size_t        SV::DISPARITY_SLOTS = 3u;
+
+
+/* Synchronization Parameters */
+// Timestamps only line up when the cameras share a clock (PTP); free-running cameras pair by frame ID, which the
+// synchronizer realigns when one camera starts late or skips an ID (see StereoSynchronizer.hpp)
+const SV::SynchronizationMode SV::SYNCHRONIZATION_MODE = SV::SYNCHRONIZE_BY_FRAME_ID;
+// Largest ID or timestamp (camera ticks) difference accepted within a pair; IDs of aligned cameras match exactly
+const uint64_t      SV::SYNCHRONIZATION_MAXIMUM_SKEW = 0u;
+// Frames of one camera that may wait for their partner
+const size_t        SV::SYNCHRONIZATION_DEPTH = 4u;
+
+
+/* Rectification Parameters */
+// Fixed-point maps: half the memory traffic of the float maps (see Rectifier.hpp)
+const SV::RemapMode SV::REMAP_MODE = SV::REMAP_FIXED_POINT_MAPS;
+// cv::INTER_NEAREST (0) or cv::INTER_LINEAR (1)
+const int           SV::REMAP_INTERPOLATION = 0;
 
 
 /* Calibration Parameters */
-const std::string   SV::CALIBRATION_BIN = "StereoCalibration";
 const std::string	SV::CALIBRATION_TIMESTAMP_FILE = "Config/Calibration/timestamp.txt";
 const std::string   SV::CALIBRATION_PATTERN_FILE = "Config/Calibration/pattern.txt";
 const std::string   SV::CALIBRATION_XML_FILES_PATH = "Config/Calibration/XMLFiles/";
@@ -37,6 +129,15 @@ const std::string	SV::CALIBRATION_IMAGES_PATH = "Config/Calibration/Images/";
 const std::string	SV::CALIBRATION_IMAGE_LEFT = "left.ppm";
 const std::string	SV::CALIBRATION_IMAGE_RIGHT = "right.ppm";
 const std::string	SV::NOT_CALIBRATED = "NOT_CALIBRATED";
+// Photos waiting for the disk before calibration capture blocks
+const size_t        SV::IMAGE_WRITER_QUEUE_CAPACITY = 8u;
+// Used when the image names above end in .png (lossless); 0-9, low levels are fastest
+const int           SV::IMAGE_WRITER_PNG_COMPRESSION = 1;
+
+
+/* Rig Parameters */
+// Stereo pairs of the frame source cameras; without it cameras 0 and 1 form the only pair, calibrated in CALIBRATION_XML_FILES_PATH
+const std::string   SV::RIG_FILE = "Config/Rig/rig.xml";
 
 
 /* Emulation Parameters */
@@ -116,40 +217,97 @@ void SV::saveCalibrationPatternFile(unsigned int w, unsigned int h, float s)
     }
 }
 
-int SV::forkExecStereoCalibrationModule(unsigned int w, unsigned int h, float s)
+std::shared_ptr<const CalibrationBundle> SV::loadCalibrationBundle(const std::string& calibrationPath)
 {
-    pid_t result, stereoCalibrationPID;
-    int status;
-    std::string width = std::to_string(w);
-    std::string height = std::to_string(h);
-    std::string size = std::to_string(s);
+    auto calibrationBundleFile = calibrationPath + CalibrationBundle::FILE_NAME;
+    auto calibrationBundle = CalibrationBundle::loadBinaryFile(calibrationBundleFile);
+    if (calibrationBundle && !calibrationBundle->getMatrix("mxy1").empty() && !calibrationBundle->getMatrix("mxy2").empty())
+        return calibrationBundle;
 
-    result = fork();
+    // Calibrations older than the binary bundle only have the XML files
+    if (!calibrationBundle)
+    {
+        std::cout << "Binary calibration bundle not found, loading XML files from " << calibrationPath << std::endl;
+        calibrationBundle = CalibrationBundle::loadXMLFiles(calibrationPath, {"Q", "mx1", "my1", "mx2", "my2"});
+        if (!calibrationBundle)
+            throw std::runtime_error("SV::loadCalibrationBundle() - No calibration found in " + calibrationPath);
+    }
 
-    if (result == -1) 
+    // Convert once to a bundle with fixed-point maps and map it from now on
+    std::cout << "Converting rectification maps to fixed-point..." << std::endl;
+    std::vector<CalibrationBundle::NamedMatrix> matrices
     {
-        std::cout << "SV::forkExecStereoCalibrationModule() ERROR: fork() status " << result << std::endl;
-        return result;
+        CalibrationBundle::NamedMatrix("Q", calibrationBundle->getMatrix("Q")),
+        CalibrationBundle::NamedMatrix("mx1", calibrationBundle->getMatrix("mx1")),
+        CalibrationBundle::NamedMatrix("my1", calibrationBundle->getMatrix("my1")),
+        CalibrationBundle::NamedMatrix("mx2", calibrationBundle->getMatrix("mx2")),
+        CalibrationBundle::NamedMatrix("my2", calibrationBundle->getMatrix("my2"))
+    };
+    for (auto& suffix : {"1", "2"})
+    {
+        auto mx = calibrationBundle->getMatrix(std::string("mx") + suffix);
+        auto my = calibrationBundle->getMatrix(std::string("my") + suffix);
+        auto fixedPointMaps = Rectifier::createFixedPointMaps(mx, my, suffix);
+        std::cout << "Camera " << suffix << " fixed-point map error: " << Rectifier::measureFixedPointError(mx, my, fixedPointMaps[0].second, fixedPointMaps[1].second) << " pixels" << std::endl;
+        matrices.insert(matrices.end(), fixedPointMaps.begin(), fixedPointMaps.end());
     }
 
-    /* Son Process - StereoCalibration */
-    if (result == 0)
-    {         
-        std::cout << "Executing Stereo Calibration Module..." << std::endl;
-        result = execl(SV::CALIBRATION_BIN.c_str(), SV::CALIBRATION_BIN.c_str(), 
-            SV::CALIBRATION_IMAGES_FILE.c_str(), width.c_str(), height.c_str(), size.c_str(), 
-            SV::CALIBRATION_XML_FILES_PATH.c_str(), NULL);
-        std::cout << "SV::forkExecStereoCalibrationModule() ERROR: execl() status " << result << std::endl;
-        if (result == -1)
-            exit(0);
+    try
+    {
+        CalibrationBundle::saveBinaryFile(calibrationBundleFile, matrices);
+        auto mappedCalibrationBundle = CalibrationBundle::loadBinaryFile(calibrationBundleFile);
+        if (mappedCalibrationBundle)
+            return mappedCalibrationBundle;
     }
-    /* Father Process - StereoVision */
+    catch (std::exception& e)
+    {
+        std::cout << e.what() << std::endl;
+    }
+
+    return CalibrationBundle::createFromMatrices(matrices);
+}
+
+std::vector<SV::RigPair> SV::loadRig(size_t numberOfCameras)
+{
+    std::vector<RigPair> rig;
+    cv::FileStorage rigFile(SV::RIG_FILE, cv::FileStorage::READ);
+    if (!rigFile.isOpened())
+        rig.push_back(RigPair("", 0u, 1u, SV::CALIBRATION_XML_FILES_PATH));
     else
-    {         
-        stereoCalibrationPID = wait(&status);
+    {
+        auto pairs = rigFile["pairs"];
+        for (auto it = pairs.begin(); it != pairs.end(); ++it)
+        {
+            auto pair = *it;
+            std::string name, calibrationPath;
+            pair["name"] >> name;
+            pair["calibration"] >> calibrationPath;
+            if (calibrationPath.empty())
+                calibrationPath = SV::CALIBRATION_XML_FILES_PATH + name + "/";
+            rig.push_back(RigPair(name, (size_t) (int) pair["left"], (size_t) (int) pair["right"], calibrationPath));
+        }
+        rigFile.release();
     }
 
-    return 0;
+    // Every camera belongs to one pair at most
+    std::vector<bool> used(numberOfCameras, false);
+    for (auto& rigPair : rig)
+    {
+        if (rigPair.left >= numberOfCameras || rigPair.right >= numberOfCameras || rigPair.left == rigPair.right || used[rigPair.left] || used[rigPair.right])
+            throw std::runtime_error("SV::loadRig() - Pair '" + rigPair.name + "' needs two distinct unused cameras out of " + std::to_string(numberOfCameras));
+        used[rigPair.left] = used[rigPair.right] = true;
+    }
+    if (rig.empty())
+        throw std::runtime_error("SV::loadRig() - No stereo pairs in " + SV::RIG_FILE);
+
+    return rig;
+}
+
+std::string SV::getCameraName(const RigPair& rigPair, size_t camera)
+{
+    // Window titles, so they must be unique across pairs
+    auto side = camera == rigPair.left ? "Left" : "Right";
+    return rigPair.name.empty() ? std::string(side) + " Camera" : rigPair.name + " " + side;
 }
 
 cv::Scalar SV::openCVRandomColor(cv::RNG& rng)
@@ -0,0 +1,85 @@
+#include <SV/VideoFrameSource.hpp>
+
+#include <stdexcept>
+
+
+VideoFrameSource::VideoFrameSource(std::string leftVideoFile, std::string rightVideoFile)
+: mVideoFiles({leftVideoFile, rightVideoFile})
+, mVideos()
+, mGrabbing(false)
+, mFinished(false)
+, mNextFrame(0u)
+{
+}
+
+void VideoFrameSource::open()
+{
+    for (size_t i = 0; i < mVideos.size(); ++i)
+    {
+        if (!mVideos[i].open(mVideoFiles[i]))
+            throw std::runtime_error("VideoFrameSource::open() - Failed to open " + mVideoFiles[i]);
+    }
+    mFinished = false;
+    mNextFrame = 0u;
+}
+
+void VideoFrameSource::close()
+{
+    mGrabbing = false;
+    for (auto& video : mVideos)
+        video.release();
+}
+
+bool VideoFrameSource::isOpen() const
+{
+    return mVideos[0].isOpened() && mVideos[1].isOpened();
+}
+
+void VideoFrameSource::startGrabbing()
+{
+    mGrabbing = isOpen();
+}
+
+void VideoFrameSource::stopGrabbing()
+{
+    mGrabbing = false;
+}
+
+bool VideoFrameSource::isGrabbing() const
+{
+    return mGrabbing && !mFinished;
+}
+
+bool VideoFrameSource::retrieveFrame(SV::Frame& frame, unsigned int timeout)
+{
+    if (!isGrabbing())
+        return false;
+
+    auto camera = mNextFrame % 2u;
+    cv::Mat image;
+    if (!mVideos[camera].read(image))
+    {
+        mFinished = true;
+        return false;
+    }
+
+    frame.image = image;
+    frame.camera = camera;
+    frame.id = mNextFrame / 2u;
+    frame.timestamp = frame.id;
+    frame.pixelFormat = image.channels() == 1 ? SV::PIXEL_FORMAT_MONO8 : SV::PIXEL_FORMAT_BGR8;
+    frame.owner.reset();
+    ++mNextFrame;
+
+    return true;
+}
+
+size_t VideoFrameSource::getNumberOfCameras() const
+{
+    return mVideos.size();
+}
+
+cv::Size VideoFrameSource::getImageSize(size_t camera) const
+{
+    return cv::Size((int) mVideos[camera].get(CV_CAP_PROP_FRAME_WIDTH), (int) mVideos[camera].get(CV_CAP_PROP_FRAME_HEIGHT));
+}